@@ -0,0 +1,106 @@
+#include "BranchSimplification.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "InstructionInfo.h"
+
+#include <iterator>   // std::next
+#include <map>
+#include <set>
+#include <string>
+
+// using namespace std;
+
+
+// Constructor
+BranchSimplification::BranchSimplification(CodeStats & Stats) :
+  Stats{Stats} {
+}
+
+bool BranchSimplification::run(subroutine & subr) {
+  instructionList & instrs = subr.instructions;
+  int threaded = 0, jumpsRemoved = 0, unreachable = 0, labelsRemoved = 0;
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+
+    // the first label of each run of consecutive labels stands for
+    // all of them; the target of a label followed by a UJUMP is the
+    // target of the UJUMP
+    std::map<std::string, std::string> canonical, forward;
+    std::string first;
+    for (auto it = instrs.begin(); it != instrs.end(); ++it) {
+      if (not InstructionInfo::isLabel(*it)) {
+        first = "";
+        continue;
+      }
+      if (first.empty()) first = InstructionInfo::getLabel(*it);
+      canonical[InstructionInfo::getLabel(*it)] = first;
+      auto next = it;
+      while (next != instrs.end() and InstructionInfo::isLabel(*next)) ++next;
+      if (next != instrs.end() and next->oper == "UJUMP")
+        forward[InstructionInfo::getLabel(*it)] = InstructionInfo::getLabel(*next);
+    }
+    auto finalTarget = [&](std::string label) {
+      std::set<std::string> seen;   // a loop of UJUMPs stays as it is
+      while (forward.count(label) and not seen.count(label)) {
+        seen.insert(label);
+        label = forward[label];
+      }
+      return canonical.count(label) ? canonical[label] : label;
+    };
+
+    for (auto it = instrs.begin(); it != instrs.end(); ) {
+      if (InstructionInfo::isJump(*it)) {
+        std::string label  = InstructionInfo::getLabel(*it);
+        std::string target = finalTarget(label);
+        if (target != label) {
+          if (not canonical.count(label) or target != canonical[label]) ++threaded;
+          InstructionInfo::setLabel(*it, target);
+          changed = true;
+        }
+        // a jump to the next instruction
+        bool toNext = false;
+        for (auto next = std::next(it);
+             next != instrs.end() and InstructionInfo::isLabel(*next); ++next)
+          toNext = toNext or canonical[InstructionInfo::getLabel(*next)] == target;
+        if (toNext) {
+          it = instrs.erase(it);
+          ++jumpsRemoved;
+          changed = true;
+          continue;
+        }
+      }
+      // the code after a UJUMP/RETURN, up to the next label
+      if (not InstructionInfo::fallsThrough(*it)) {
+        for (auto next = std::next(it);
+             next != instrs.end() and not InstructionInfo::isLabel(*next); ) {
+          next = instrs.erase(next);
+          ++unreachable;
+          changed = true;
+        }
+      }
+      ++it;
+    }
+
+    // the labels no jump refers to
+    std::set<std::string> referenced;
+    for (auto & instr : instrs)
+      if (InstructionInfo::isJump(instr)) referenced.insert(InstructionInfo::getLabel(instr));
+    for (auto it = instrs.begin(); it != instrs.end(); ) {
+      if (InstructionInfo::isLabel(*it) and not referenced.count(InstructionInfo::getLabel(*it))) {
+        it = instrs.erase(it);
+        ++labelsRemoved;
+        changed = true;
+      }
+      else ++it;
+    }
+  }
+
+  Stats.addCounter(subr.name, "branches.threaded", threaded);
+  Stats.addCounter(subr.name, "branches.jumps_removed", jumpsRemoved);
+  Stats.addCounter(subr.name, "branches.unreachable", unreachable);
+  Stats.addCounter(subr.name, "branches.labels_removed", labelsRemoved);
+  return threaded + jumpsRemoved + unreachable + labelsRemoved > 0;
+}
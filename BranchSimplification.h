@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class BranchSimplification: cleans up the jumps and labels left by
+// the nested if/while statements, until nothing changes:
+//   - a jump to a label followed by a UJUMP goes directly to the
+//     target of that UJUMP (jump threading)
+//   - a jump to the instruction that comes next anyway is removed
+//   - the instructions after a UJUMP/RETURN that no label reaches are
+//     removed
+//   - consecutive labels are merged into the first one, and the labels
+//     no jump refers to are removed
+
+class BranchSimplification {
+
+public:
+
+  // Constructor
+  BranchSimplification(CodeStats & Stats);
+
+  // Runs the pass on subr. Returns true if the code changed
+  bool run(subroutine & subr);
+
+private:
+
+  // Attributes
+  CodeStats & Stats;
+
+};  // class BranchSimplification
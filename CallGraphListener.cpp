@@ -0,0 +1,57 @@
+#include "CallGraphListener.h"
+
+#include "antlr4-runtime.h"
+
+#include <string>
+#include <vector>
+
+// uncomment the following line to enable debugging messages with DEBUG*
+// #define DEBUG_BUILD
+#include "../common/debug.h"
+
+// using namespace std;
+
+
+// Constructor
+CallGraphListener::CallGraphListener() {
+}
+
+void CallGraphListener::enterFunction(AslParser::FunctionContext *ctx) {
+  DEBUG_ENTER();
+  currentFunction = ctx->ID()->getText();
+  callees[currentFunction];
+}
+void CallGraphListener::exitFunction(AslParser::FunctionContext *ctx) {
+  currentFunction = "";
+  DEBUG_EXIT();
+}
+
+void CallGraphListener::enterProcCall(AslParser::ProcCallContext *ctx) {
+  DEBUG_ENTER();
+}
+void CallGraphListener::exitProcCall(AslParser::ProcCallContext *ctx) {
+  callees[currentFunction].insert(ctx->ident()->getText());
+  DEBUG_EXIT();
+}
+
+void CallGraphListener::enterFuncCall(AslParser::FuncCallContext * ctx) {
+  DEBUG_ENTER();
+}
+void CallGraphListener::exitFuncCall(AslParser::FuncCallContext * ctx) {
+  callees[currentFunction].insert(ctx->ident()->getText());
+  DEBUG_EXIT();
+}
+
+std::set<std::string> CallGraphListener::getReachable(const std::string & root) const {
+  std::set<std::string>    reachable = {root};
+  std::vector<std::string> pending   = {root};
+  while (not pending.empty()) {
+    std::string f = pending.back();
+    pending.pop_back();
+    auto it = callees.find(f);
+    if (it == callees.end()) continue;   // imported from another module
+    for (auto & g : it->second)
+      if (reachable.insert(g).second) pending.push_back(g);
+  }
+  return reachable;
+}
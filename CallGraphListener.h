@@ -0,0 +1,48 @@
+#pragma once
+
+#include "antlr4-runtime.h"
+#include "AslBaseListener.h"
+
+#include <map>
+#include <set>
+#include <string>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class CallGraphListener: derived from AslBaseListener.
+// The tree walker go through the parse tree and call the methods of
+// this listener to build the call graph of the program: an edge from
+// each function to every function named in one of its procCall or
+// funcCall statements/expressions. It is used to generate code only
+// for the functions that can be reached from main. If an enter/exit
+// method does not have an associated task, it does not have to be
+// redefined.
+
+class CallGraphListener final : public AslBaseListener {
+
+public:
+
+  // Constructor
+  CallGraphListener();
+
+  void enterFunction(AslParser::FunctionContext *ctx);
+  void exitFunction(AslParser::FunctionContext *ctx);
+
+  void enterProcCall(AslParser::ProcCallContext *ctx);
+  void exitProcCall(AslParser::ProcCallContext *ctx);
+
+  void enterFuncCall(AslParser::FuncCallContext * ctx);
+  void exitFuncCall(AslParser::FuncCallContext * ctx);
+
+  // Functions that can be reached from 'root' (root included)
+  std::set<std::string> getReachable(const std::string & root) const;
+
+private:
+
+  // Attributes
+  std::map<std::string, std::set<std::string>> callees;
+  std::string                                  currentFunction;
+
+};  // class CallGraphListener
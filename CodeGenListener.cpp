@@ -6,8 +6,12 @@
 #include "../common/SymTable.h"
 #include "../common/TreeDecoration.h"
 #include "../common/code.h"
+#include "CodeStats.h"
+#include "ConstValue.h"
+#include "InstructionInfo.h"
 
 #include <cstddef>    // std::size_t
+#include <set>
 
 // uncomment the following line to enable debugging messages with DEBUG*
 // #define DEBUG_BUILD
@@ -20,11 +24,13 @@
 CodeGenListener::CodeGenListener(TypesMgr       & Types,
 				 SymTable       & Symbols,
 				 TreeDecoration & Decorations,
-				 code           & Code) :
+				 code           & Code,
+				 CodeStats      & Stats) :
   Types{Types},
   Symbols{Symbols},
   Decorations{Decorations},
-  Code{Code} {
+  Code{Code},
+  Stats{Stats} {
 }
 
 void CodeGenListener::enterProgram(AslParser::ProgramContext *ctx) {
@@ -47,10 +53,15 @@ void CodeGenListener::enterFunction(AslParser::FunctionContext *ctx) {
   SymTable::ScopeId sc = getScopeDecor(ctx);
   Symbols.pushThisScope(sc);
   codeCounters.reset();
+  ArrayParamBases.clear();
 }
 void CodeGenListener::exitFunction(AslParser::FunctionContext *ctx) {
   subroutine & subrRef = Code.get_last_subroutine();
-  instructionList code = getCodeDecor(ctx->statements());
+  // the base addresses of the array parameters used, loaded once
+  instructionList code;
+  for (auto & base : ArrayParamBases)
+    code = code || instruction::LOAD(base.second, base.first);
+  code = code || getCodeDecor(ctx->statements());
   code = code || instruction::RETURN();
   subrRef.set_instructions(code);
   Symbols.popScope();
@@ -87,6 +98,7 @@ void CodeGenListener::exitVariable_decl(AslParser::Variable_declContext *ctx) {
     TypesMgr::TypeId        t1 = getTypeDecor(ctx->type());
     std::size_t           size = Types.getSizeOfType(t1);
     subrRef.add_var(i->getText(), size);
+    Stats.addCounter(subrRef.name, "frame_size", size);
   }
   DEBUG_EXIT();
 } 
@@ -135,44 +147,37 @@ void CodeGenListener::exitAssignStmt(AslParser::AssignStmtContext *ctx) {
     bool isLocalLE = Symbols.isLocalVarClass(addrLE);
     bool isLocalE  = Symbols.isLocalVarClass(addrE);
 
-    std::string tempAddrLE = "%"+codeCounters.newTEMP();
-    std::string tempAddrE  = "%"+codeCounters.newTEMP();
-
-    if (not isLocalLE) code = code || instruction::LOAD(tempAddrLE, addrLE);
-    if (not isLocalE)  code = code || instruction::LOAD(tempAddrE, addrE);
+    std::string baseLE = isLocalLE ? addrLE : getArrayParamBase(addrLE);
+    std::string baseE  = isLocalE  ? addrE  : getArrayParamBase(addrE);
 
     std::string tempIndex  = "%"+codeCounters.newTEMP();
     std::string tempIncrem = "%"+codeCounters.newTEMP();
     std::string tempSize   = "%"+codeCounters.newTEMP();
-    std::string tempOffset = "%"+codeCounters.newTEMP();
-    std::string tempOffHld = "%"+codeCounters.newTEMP();
     std::string tempCompar = "%"+codeCounters.newTEMP();
     std::string tempValue  = "%"+codeCounters.newTEMP();
 
     std::string labelWhile = "while"+codeCounters.newLabelWHILE();
-    std::string labelEndWhile = "end"+labelWhile;
 
     code = code || instruction::ILOAD(tempIndex, "0");
     code = code || instruction::ILOAD(tempIncrem, "1");
     code = code || instruction::ILOAD(tempSize, std::to_string(Types.getArraySize(Symbols.getType(addrLE))));
-    code = code || instruction::ILOAD(tempOffset, "1");
 
+    // an array has at least one element: do { ... } while (index < size)
     code = code || instruction::LABEL(labelWhile);
-    code = code || instruction::LT(tempCompar, tempIndex, tempSize);
-    code = code || instruction::FJUMP(tempCompar, labelEndWhile);
-    code = code || instruction::MUL(tempOffHld, tempOffset, tempIndex);
-    code = code || instruction::LOADX(tempValue, isLocalE ? addrE : tempAddrE, tempOffHld);
-    code = code || instruction::XLOAD(isLocalLE ? addrLE : tempAddrLE, tempOffHld, tempValue);
+    code = code || instruction::LOADX(tempValue, baseE, tempIndex);
+    code = code || instruction::XLOAD(baseLE, tempIndex, tempValue);
     code = code || instruction::ADD(tempIndex, tempIndex, tempIncrem);
-    code = code || instruction::UJUMP(labelWhile);
-    code = code || instruction::LABEL(labelEndWhile);
+    code = code || instruction::LE(tempCompar, tempSize, tempIndex);
+    code = code || instruction::FJUMP(tempCompar, labelWhile);
+
+    Stats.addCounter(Code.get_last_subroutine().name, "array_copies");
   }
   
   // int2float CAST for array or non array
   if (Types.isFloatTy(tidLE) and Types.isIntegerTy(tidE)) {
     
     std::string tempF = "%"+codeCounters.newTEMP();
-    code = code || instruction::FLOAT(tempF, addrE);
+    code = code || int2float(ctx->expr(), tempF);
     putAddrDecor(ctx->expr(), tempF);
     addrE = getAddrDecor(ctx->expr());
   }
@@ -197,8 +202,6 @@ void CodeGenListener::enterIfStmt(AslParser::IfStmtContext *ctx) {
 void CodeGenListener::exitIfStmt(AslParser::IfStmtContext *ctx) {
   // IF expr THEN statements(0) [ELSE statements(1)] ENDIF
   instructionList  code;
-  std::string      addrExpr = getAddrDecor(ctx->expr());        // addr if(expr)
-  instructionList  codeExpr = getCodeDecor(ctx->expr());        // code if(expr)
   instructionList  codeS0   = getCodeDecor(ctx->statements(0)); // code statements(0)
 
   std::string labelIf    = codeCounters.newLabelIF();   //  1
@@ -209,15 +212,22 @@ void CodeGenListener::exitIfStmt(AslParser::IfStmtContext *ctx) {
 
     instructionList codeS1    = getCodeDecor(ctx->statements(1)); // code statements(1)
     std::string     labelElse = "else"+labelIf;   // else1
-
-    code =  codeExpr || instruction::FJUMP(addrExpr, labelElse) ||
-            codeS0 || instruction::UJUMP(labelEndIf) || instruction::LABEL(labelElse) ||
-            codeS1 || instruction::LABEL(labelEndIf);
+    std::string     labelThen = "then"+labelIf;   // then1
+
+    // a != b: jumps to the THEN part when a == b is false
+    if (isNotEqual(ctx->expr()))
+      code =  branchIf(ctx->expr(), true, labelThen) ||
+              codeS1 || instruction::UJUMP(labelEndIf) || instruction::LABEL(labelThen) ||
+              codeS0 || instruction::LABEL(labelEndIf);
+    else
+      code =  branchIf(ctx->expr(), false, labelElse) ||
+              codeS0 || instruction::UJUMP(labelEndIf) || instruction::LABEL(labelElse) ||
+              codeS1 || instruction::LABEL(labelEndIf);
   }
   // IF
   else {
 
-    code =  codeExpr || instruction::FJUMP(addrExpr, labelEndIf) ||
+    code =  branchIf(ctx->expr(), false, labelEndIf) ||
             codeS0 || instruction::LABEL(labelEndIf);
   }
 
@@ -231,15 +241,18 @@ void CodeGenListener::enterWhileStmt(AslParser::WhileStmtContext * ctx) {
 void CodeGenListener::exitWhileStmt(AslParser::WhileStmtContext * ctx) {
   
   instructionList code;
-  std::string     addrE = getAddrDecor(ctx->expr());
-  instructionList codeE = getCodeDecor(ctx->expr());
   instructionList codeS = getCodeDecor(ctx->statements());
 
   std::string     labelWhile    = "while"+codeCounters.newLabelWHILE();
   std::string     labelEndWhile = "end"+labelWhile;
 
-  code =  instruction::LABEL(labelWhile) || codeE || instruction::FJUMP(addrE, labelEndWhile) ||
-          codeS || instruction::UJUMP(labelWhile) || instruction::LABEL(labelEndWhile);
+  // Rotated loop, with one conditional jump per iteration:
+  //   if (cond) do { statements } while (cond)
+  // The code of the condition is repeated, with its own labels
+  code =  branchIf(ctx->expr(), false, labelEndWhile) ||
+          instruction::LABEL(labelWhile) || codeS ||
+          relabel(branchIf(ctx->expr(), true, labelWhile), "_"+labelWhile) ||
+          instruction::LABEL(labelEndWhile);
   
   putCodeDecor(ctx, code);
   DEBUG_EXIT();
@@ -263,7 +276,7 @@ void CodeGenListener::exitProcCall(AslParser::ProcCallContext *ctx) {
     if (Types.isFloatTy(param_types[k]) and Types.isIntegerTy(getTypeDecor(i))) {
       
       std::string tempF = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(tempF, getAddrDecor(i));
+      code = code || int2float(i, tempF);
       putAddrDecor(i, tempF);
     }
     // passing an ARRAY by REFERENCE
@@ -427,15 +440,13 @@ void CodeGenListener::exitLeft_expr(AslParser::Left_exprContext *ctx) {
   // CAS ARRAY
   if (ctx->expr()) {
 
-    std::string tempOff = "%"+codeCounters.newTEMP();
+    // elements have size 1: the offset is the index itself
     offset = getAddrDecor(ctx->expr());
 
     // Array LOCAL
     if (Symbols.isLocalVarClass(address)) {
       
       code = code || getCodeDecor(ctx->expr());
-      code = code || instruction::LOAD(tempOff, "1");
-      code = code || instruction::MUL(tempOff, offset, tempOff);
 
       putAddrDecor(ctx, address);
     }
@@ -443,15 +454,11 @@ void CodeGenListener::exitLeft_expr(AslParser::Left_exprContext *ctx) {
     else {
 
       code = code || getCodeDecor(ctx->expr());
-      std::string tempA = "%"+codeCounters.newTEMP();
-      code = code || instruction::LOAD(tempA, address);
-      code = code || instruction::LOAD(tempOff, "1");
-      code = code || instruction::MUL(tempOff, offset, tempOff);
 
-      putAddrDecor(ctx, tempA);
+      putAddrDecor(ctx, getArrayParamBase(address));
     }
 
-    putOffsetDecor(ctx, tempOff);
+    putOffsetDecor(ctx, offset);
     putCodeDecor(ctx, code);
   }
 
@@ -477,10 +484,33 @@ void CodeGenListener::exitUnary(AslParser::UnaryContext * ctx) {
   instructionList code  = codeE;
 
   TypesMgr::TypeId t  = getTypeDecor(ctx->expr());
+
+  // CONSTANT FOLDING
+  ConstValue c0, c;
+  if (getConstDecor(ctx->expr(), c0)) {
+    bool folded = true;
+    if (ctx->NOT())       folded = ConstValue::evaluate("NOT", c0, c0, c);
+    else if (ctx->SUB())  folded = ConstValue::evaluate(Types.isFloatTy(t) ? "FNEG" : "NEG", c0, c0, c);
+    else /*ctx->ADD()*/   c = c0;
+    if (folded and putFoldedDecor(ctx, c)) {
+      DEBUG_EXIT();
+      return;
+    }
+  }
+
+  // Unary plus does nothing, the value is the one of expr
+  if (ctx->ADD()) {
+    putAddrDecor(ctx, addrE);
+    putOffsetDecor(ctx, "");
+    putCodeDecor(ctx, code);
+    DEBUG_EXIT();
+    return;
+  }
+
   std::string temp    = "%"+codeCounters.newTEMP();
 
   if (ctx->NOT())       code = code || instruction::NOT(temp, addrE);
-  else if (ctx->SUB())  code = code || (Types.isFloatTy(t) ? instruction::FNEG(temp, addrE) :
+  else /*ctx->SUB()*/   code = code || (Types.isFloatTy(t) ? instruction::FNEG(temp, addrE) :
                                                              instruction::NEG(temp, addrE)) ;
 
   putAddrDecor(ctx, temp);
@@ -507,6 +537,14 @@ void CodeGenListener::exitArithmetic(AslParser::ArithmeticContext *ctx) {
   TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(1));
   TypesMgr::TypeId t  = getTypeDecor(ctx);
 
+  // CONSTANT FOLDING: both operands known at compile time
+  ConstValue c0, c1, c;
+  if (getConstDecor(ctx->expr(0), c0) and getConstDecor(ctx->expr(1), c1) and
+      foldBinary(ctx->op->getText(), Types.isFloatTy(t), c0, c1, c) and putFoldedDecor(ctx, c)) {
+    DEBUG_EXIT();
+    return;
+  }
+
   // stores the temporal FLOAT cast if isFloat(t0) XOR isFloat(t1)
   bool floatXor     = Types.isFloatTy(t0) != Types.isFloatTy(t1);
   std::string tempF = floatXor ? "%"+codeCounters.newTEMP() : "";
@@ -519,6 +557,10 @@ void CodeGenListener::exitArithmetic(AslParser::ArithmeticContext *ctx) {
     else if (ctx->ADD())  code = code || instruction::ADD(temp, addrE0, addrE1);
     else if (ctx->DIV())  code = code || instruction::DIV(temp, addrE0, addrE1);
     else if (ctx->SUB())  code = code || instruction::SUB(temp, addrE0, addrE1);
+    // x % 1 is 0 (x is still evaluated). x % -1 divides: it traps on
+    // the smallest int, like x / -1
+    else if (getConstDecor(ctx->expr(1), c1) and c1.i == 1)
+                          code = code || instruction::ILOAD(temp, "0");
     else /* ctx->MOD() */ code = code || instruction::DIV(temp, addrE0, addrE1) 
                                       || instruction::MUL(temp, temp, addrE1) 
                                       || instruction::SUB(temp, addrE0, temp);
@@ -527,8 +569,8 @@ void CodeGenListener::exitArithmetic(AslParser::ArithmeticContext *ctx) {
   // FLOAT [MOD not possible with FLOAT]
   else {
 
-    instruction cast = Types.isIntegerTy(t0) ? instruction::FLOAT(tempF, addrE0) :
-                                               instruction::FLOAT(tempF, addrE1) ;
+    instructionList cast = Types.isIntegerTy(t0) ? int2float(ctx->expr(0), tempF) :
+                                                   int2float(ctx->expr(1), tempF) ;
     // One FLOAT but NOT both
     if (floatXor) {
 
@@ -573,6 +615,15 @@ void CodeGenListener::exitRelational(AslParser::RelationalContext *ctx) {
   TypesMgr::TypeId t1 = getTypeDecor(ctx->expr(1));
   //TypesMgr::TypeId t  = getTypeDecor(ctx);
 
+  // CONSTANT FOLDING: both operands known at compile time
+  ConstValue c0, c1, c;
+  if (getConstDecor(ctx->expr(0), c0) and getConstDecor(ctx->expr(1), c1) and
+      foldBinary(ctx->op->getText(), Types.isFloatTy(t0) or Types.isFloatTy(t1), c0, c1, c) and
+      putFoldedDecor(ctx, c)) {
+    DEBUG_EXIT();
+    return;
+  }
+
   // stores the temporal FLOAT cast if isFloat(t0) XOR isFloat(t1)
   bool floatXor     = Types.isFloatTy(t0) != Types.isFloatTy(t1);
   std::string tempF = floatXor ? "%"+codeCounters.newTEMP() : "";
@@ -592,8 +643,8 @@ void CodeGenListener::exitRelational(AslParser::RelationalContext *ctx) {
   // FLOAT
   else {
 
-    instruction cast = Types.isIntegerTy(t0) ? instruction::FLOAT(tempF, addrE0) :
-                                               instruction::FLOAT(tempF, addrE1) ;
+    instructionList cast = Types.isIntegerTy(t0) ? int2float(ctx->expr(0), tempF) :
+                                                   int2float(ctx->expr(1), tempF) ;
     // One FLOAT but NOT both
     if (floatXor) {
 
@@ -643,6 +694,11 @@ void CodeGenListener::exitValue(AslParser::ValueContext *ctx) {
                             code = instruction::CHLOAD(temp, s.substr(1,s.size()-2));}
   else /* ctx->BOOLVAL() */ code = instruction::LOAD(temp, (ctx->getText()=="true" ? "1":"0"));
 
+  // the literal just loaded is the value of the expression
+  ConstValue c;
+  if (ConstValue::fromLiteral(code.back().oper, code.back().arg2, c))
+    putConstDecor(ctx, c);
+
   putAddrDecor(ctx, temp);
   putOffsetDecor(ctx, "");
   putCodeDecor(ctx, code);
@@ -657,6 +713,8 @@ void CodeGenListener::exitParenthesis(AslParser::ParenthesisContext * ctx) {
   putAddrDecor(ctx, getAddrDecor(ctx->expr()));
   putOffsetDecor(ctx, getOffsetDecor(ctx->expr()));
   putCodeDecor(ctx, getCodeDecor(ctx->expr()));
+  ConstValue c;
+  if (getConstDecor(ctx->expr(), c)) putConstDecor(ctx, c);
   DEBUG_EXIT();
 }
 
@@ -669,12 +727,59 @@ void CodeGenListener::exitLogical(AslParser::LogicalContext * ctx) {
   instructionList codeE0 = getCodeDecor(ctx->expr(0));
   std::string     addrE1 = getAddrDecor(ctx->expr(1));
   instructionList codeE1 = getCodeDecor(ctx->expr(1));
-  instructionList code  = codeE0 || codeE1;
+  instructionList code;
+
+  // CONSTANT FOLDING: both operands known at compile time
+  ConstValue c0, c1, c;
+  bool knownE0 = getConstDecor(ctx->expr(0), c0);
+  if (knownE0 and getConstDecor(ctx->expr(1), c1) and
+      foldBinary(ctx->op->getText(), false, c0, c1, c) and putFoldedDecor(ctx, c)) {
+    DEBUG_EXIT();
+    return;
+  }
+  // the left operand known: it decides (false and E1, true or E1),
+  // or the result is the right operand
+  if (knownE0) {
+    if ((ctx->AND() and not c0.i) or (ctx->OR() and c0.i)) {
+      putFoldedDecor(ctx, c0);
+    }
+    else {
+      putAddrDecor(ctx, addrE1);
+      putOffsetDecor(ctx, "");
+      putCodeDecor(ctx, codeE1);
+    }
+    DEBUG_EXIT();
+    return;
+  }
 
   std::string temp = "%"+codeCounters.newTEMP();
 
-  if (ctx->AND())     code = code || instruction::AND(temp, addrE0, addrE1);
-  else /*ctx->OR()*/  code = code || instruction::OR(temp, addrE0, addrE1);
+  // SHORT-CIRCUIT: the right operand is only evaluated when the left
+  // one does not decide. A right operand that can not be told apart
+  // (no calls, no array reads, no division) is evaluated anyway
+  bool cheapE1 = true;
+  for (auto & instr : codeE1)
+    cheapE1 = cheapE1 and InstructionInfo::isPure(instr) and
+              not InstructionInfo::hasSideEffects(instr);
+
+  if (cheapE1) {
+    code = codeE0 || codeE1;
+    if (ctx->AND())     code = code || instruction::AND(temp, addrE0, addrE1);
+    else /*ctx->OR()*/  code = code || instruction::OR(temp, addrE0, addrE1);
+  }
+  else if (ctx->AND()) {
+    std::string labelEnd = "endand"+codeCounters.newLabelIF();   // endand1
+    code = codeE0 || instruction::LOAD(temp, addrE0) || instruction::FJUMP(temp, labelEnd) ||
+           codeE1 || instruction::LOAD(temp, addrE1) || instruction::LABEL(labelEnd);
+  }
+  else /*ctx->OR()*/ {
+    std::string labelOr    = codeCounters.newLabelIF();
+    std::string labelRight = "rightor"+labelOr;                  // rightor1
+    std::string labelEnd   = "endor"+labelOr;                    // endor1
+    code = codeE0 || instruction::LOAD(temp, addrE0) || instruction::FJUMP(temp, labelRight) ||
+           instruction::UJUMP(labelEnd) || instruction::LABEL(labelRight) ||
+           codeE1 || instruction::LOAD(temp, addrE1) || instruction::LABEL(labelEnd);
+  }
 
   putAddrDecor(ctx, temp);
   putOffsetDecor(ctx, "");
@@ -703,22 +808,16 @@ void CodeGenListener::exitArrayIndex(AslParser::ArrayIndexContext * ctx) {
   std::string     offset  = getAddrDecor(ctx->expr());
   
   std::string     temp    = "%"+codeCounters.newTEMP();
-  std::string     tempOff = "%"+codeCounters.newTEMP();
-
-  code = code || instruction::LOAD(tempOff, "1");
-  code = code || instruction::MUL(tempOff, offset, tempOff);
 
   // LOCAL
   if (Symbols.isLocalVarClass(addrI)) {
     
-    code = code || instruction::LOADX(temp, addrI, tempOff);
+    code = code || instruction::LOADX(temp, addrI, offset);
   }
   // PARAM REF
   else {
 
-    std::string tempA = "%"+codeCounters.newTEMP();
-    code = code || instruction::LOAD(tempA, addrI);
-    code = code || instruction::LOADX(temp, tempA, tempOff);
+    code = code || instruction::LOADX(temp, getArrayParamBase(addrI), offset);
   }
 
   putAddrDecor(ctx, temp);
@@ -747,7 +846,7 @@ void CodeGenListener::exitFuncCall(AslParser::FuncCallContext * ctx) {
     if (Types.isFloatTy(param_types[k]) and Types.isIntegerTy(getTypeDecor(i))) {
 
       std::string tempF = "%"+codeCounters.newTEMP();
-      code = code || instruction::FLOAT(tempF,getAddrDecor(i));
+      code = code || int2float(i, tempF);
       putAddrDecor(i, tempF);
     }
     // passing an ARRAY by REFERENCE
@@ -835,3 +934,177 @@ void CodeGenListener::putOffsetDecor(antlr4::ParserRuleContext *ctx, const std::
 void CodeGenListener::putCodeDecor(antlr4::ParserRuleContext *ctx, const instructionList & c) {
   Decorations.putCode(ctx, c);
 }
+
+// Getter and setter for the constant value of an expression
+bool CodeGenListener::getConstDecor(antlr4::ParserRuleContext *ctx, ConstValue & v) {
+  auto it = ConstDecorations.find(ctx);
+  if (it == ConstDecorations.end()) return false;
+  v = it->second;
+  return true;
+}
+void CodeGenListener::putConstDecor(antlr4::ParserRuleContext *ctx, const ConstValue & v) {
+  ConstDecorations[ctx] = v;
+}
+
+// Constant folding of a binary operator, instruction by instruction
+bool CodeGenListener::foldBinary(const std::string & op, bool isFloat,
+                                 ConstValue c0, ConstValue c1, ConstValue & c) {
+  // int2float CAST
+  if (isFloat and c0.kind == ConstValue::INT and not ConstValue::evaluate("FLOAT", c0, c0, c0))
+    return false;
+  if (isFloat and c1.kind == ConstValue::INT and not ConstValue::evaluate("FLOAT", c1, c1, c1))
+    return false;
+
+  std::string F = isFloat ? "F" : "";
+  ConstValue q, p;
+  if (op == "*")   return ConstValue::evaluate(F+"MUL", c0, c1, c);
+  if (op == "/")   return ConstValue::evaluate(F+"DIV", c0, c1, c);
+  if (op == "+")   return ConstValue::evaluate(F+"ADD", c0, c1, c);
+  if (op == "-")   return ConstValue::evaluate(F+"SUB", c0, c1, c);
+  if (op == "%")   return ConstValue::evaluate("DIV", c0, c1, q) and
+                          ConstValue::evaluate("MUL", q, c1, p) and
+                          ConstValue::evaluate("SUB", c0, p, c);
+  if (op == "==")  return ConstValue::evaluate(F+"EQ", c0, c1, c);
+  if (op == "!=")  return ConstValue::evaluate(F+"EQ", c0, c1, p) and ConstValue::evaluate("NOT", p, p, c);
+  if (op == "<")   return ConstValue::evaluate(F+"LT", c0, c1, c);
+  if (op == "<=")  return ConstValue::evaluate(F+"LE", c0, c1, c);
+  if (op == ">")   return ConstValue::evaluate(F+"LE", c0, c1, p) and ConstValue::evaluate("NOT", p, p, c);
+  if (op == ">=")  return ConstValue::evaluate(F+"LT", c0, c1, p) and ConstValue::evaluate("NOT", p, p, c);
+  if (op == "and") return ConstValue::evaluate("AND", c0, c1, c);
+  if (op == "or")  return ConstValue::evaluate("OR", c0, c1, c);
+  return false;
+}
+
+bool CodeGenListener::putFoldedDecor(antlr4::ParserRuleContext *ctx, const ConstValue & c) {
+  std::string     temp = "%"+codeCounters.newTEMP();
+  instructionList code;
+  if (not c.load(temp, code)) return false;
+  putAddrDecor(ctx, temp);
+  putOffsetDecor(ctx, "");
+  putCodeDecor(ctx, code);
+  putConstDecor(ctx, c);
+  return true;
+}
+
+std::string CodeGenListener::getArrayParamBase(const std::string & param) {
+  auto it = ArrayParamBases.find(param);
+  if (it != ArrayParamBases.end()) return it->second;
+  std::string temp = "%"+codeCounters.newTEMP();
+  ArrayParamBases[param] = temp;
+  return temp;
+}
+
+instructionList CodeGenListener::int2float(antlr4::ParserRuleContext *ctx, const std::string & tempF) {
+  instructionList code;
+  ConstValue      c;
+  if (getConstDecor(ctx, c) and ConstValue::evaluate("FLOAT", c, c, c) and c.load(tempF, code))
+    return code;
+  return instruction::FLOAT(tempF, getAddrDecor(ctx));
+}
+
+instructionList CodeGenListener::branchIf(AslParser::ExprContext *ctx, bool jumpWhen,
+                                          const std::string & label) {
+  instructionList code;
+
+  // known at compile time: always or never jumps
+  ConstValue c;
+  if (getConstDecor(ctx, c)) {
+    if (bool(c.i) == jumpWhen) code = instruction::UJUMP(label);
+    return code;
+  }
+
+  if (auto paren = dynamic_cast<AslParser::ParenthesisContext *>(ctx))
+    return branchIf(paren->expr(), jumpWhen, label);
+
+  if (auto unary = dynamic_cast<AslParser::UnaryContext *>(ctx)) {
+    if (unary->NOT()) return branchIf(unary->expr(), not jumpWhen, label);
+  }
+
+  // AND/OR: the right operand is only reached if the left one does
+  // not decide
+  if (auto logical = dynamic_cast<AslParser::LogicalContext *>(ctx)) {
+    bool decides = not logical->AND();   // false and .., true or ..
+    if (decides == jumpWhen)
+      return branchIf(logical->expr(0), jumpWhen, label) ||
+             branchIf(logical->expr(1), jumpWhen, label);
+    std::string labelCont = "cont"+codeCounters.newLabelIF();   // cont1
+    return branchIf(logical->expr(0), decides, labelCont) ||
+           branchIf(logical->expr(1), jumpWhen, label) || instruction::LABEL(labelCont);
+  }
+
+  // RELATIONAL: jumping when the comparison is true is jumping when
+  // the opposite one is false
+  if (auto relational = dynamic_cast<AslParser::RelationalContext *>(ctx)) {
+    std::string     addrE0 = getAddrDecor(relational->expr(0));
+    std::string     addrE1 = getAddrDecor(relational->expr(1));
+    TypesMgr::TypeId t0    = getTypeDecor(relational->expr(0));
+    TypesMgr::TypeId t1    = getTypeDecor(relational->expr(1));
+    bool isFloat = Types.isFloatTy(t0) or Types.isFloatTy(t1);
+    code = getCodeDecor(relational->expr(0)) || getCodeDecor(relational->expr(1));
+
+    // int2float CAST of one of the operands
+    if (isFloat and not Types.isFloatTy(t0)) {
+      std::string tempF = "%"+codeCounters.newTEMP();
+      code   = code || int2float(relational->expr(0), tempF);
+      addrE0 = tempF;
+    }
+    if (isFloat and not Types.isFloatTy(t1)) {
+      std::string tempF = "%"+codeCounters.newTEMP();
+      code   = code || int2float(relational->expr(1), tempF);
+      addrE1 = tempF;
+    }
+
+    std::string op = relational->op->getText();
+    if (jumpWhen) {
+      static const std::map<std::string, std::string> opposite = {
+        {"==", "!="}, {"!=", "=="}, {"<", ">="}, {">=", "<"}, {"<=", ">"}, {">", "<="} };
+      op = opposite.at(op);
+    }
+
+    // jumps when 'E0 op E1' is false
+    std::string temp = "%"+codeCounters.newTEMP();
+    if (op == "<")
+      code = code || (isFloat ? instruction::FLT(temp, addrE0, addrE1) : instruction::LT(temp, addrE0, addrE1));
+    else if (op == "<=")
+      code = code || (isFloat ? instruction::FLE(temp, addrE0, addrE1) : instruction::LE(temp, addrE0, addrE1));
+    else if (op == ">")
+      code = code || (isFloat ? instruction::FLT(temp, addrE1, addrE0) : instruction::LT(temp, addrE1, addrE0));
+    else if (op == ">=")
+      code = code || (isFloat ? instruction::FLE(temp, addrE1, addrE0) : instruction::LE(temp, addrE1, addrE0));
+    else
+      code = code || (isFloat ? instruction::FEQ(temp, addrE0, addrE1) : instruction::EQ(temp, addrE0, addrE1));
+
+    if (op != "!=")
+      return code || instruction::FJUMP(temp, label);
+    // a != b is false when a == b is true
+    std::string labelCont = "cont"+codeCounters.newLabelIF();   // cont1
+    return code || instruction::FJUMP(temp, labelCont) || instruction::UJUMP(label) ||
+           instruction::LABEL(labelCont);
+  }
+
+  // any other boolean value
+  code = getCodeDecor(ctx);
+  std::string addr = getAddrDecor(ctx);
+  if (not jumpWhen) return code || instruction::FJUMP(addr, label);
+  std::string temp = "%"+codeCounters.newTEMP();
+  return code || instruction::NOT(temp, addr) || instruction::FJUMP(temp, label);
+}
+
+bool CodeGenListener::isNotEqual(AslParser::ExprContext *ctx) {
+  while (auto paren = dynamic_cast<AslParser::ParenthesisContext *>(ctx))
+    ctx = paren->expr();
+  auto relational = dynamic_cast<AslParser::RelationalContext *>(ctx);
+  return relational and relational->NEQ();
+}
+
+instructionList CodeGenListener::relabel(const instructionList & code, const std::string & suffix) {
+  std::set<std::string> labels;
+  for (auto & instr : code)
+    if (InstructionInfo::isLabel(instr)) labels.insert(InstructionInfo::getLabel(instr));
+  instructionList renamed = code;
+  for (auto & instr : renamed)
+    if ((InstructionInfo::isLabel(instr) or InstructionInfo::isJump(instr)) and
+        labels.count(InstructionInfo::getLabel(instr)))
+      InstructionInfo::setLabel(instr, InstructionInfo::getLabel(instr) + suffix);
+  return renamed;
+}
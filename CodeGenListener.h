@@ -36,7 +36,10 @@
 #include "../common/SymTable.h"
 #include "../common/TreeDecoration.h"
 #include "../common/code.h"
+#include "CodeStats.h"
+#include "ConstValue.h"
 
+#include <map>
 #include <string>
 
 // using namespace std;
@@ -49,8 +52,11 @@
 // once the SymbolsListener and TypeCheckListener have finish with no
 // semantic error. So all the symbols of the program has been added to
 // their respective scope and the type of each expresion has also be
-// computed and decorate the parse tree. If an enter/exit method does
-// not have an associated task, it does not have to be redefined.
+// computed and decorate the parse tree. Expressions whose value is
+// known at compile time are also decorated with it, so an operation on
+// constants is folded into the load of its result. If an enter/exit
+// method does not have an associated task, it does not have to be
+// redefined.
 
 class  CodeGenListener : public AslBaseListener {
 
@@ -60,7 +66,8 @@ public:
   CodeGenListener(TypesMgr       & Types,
 		  SymTable       & Symbols,
 		  TreeDecoration & TreeNodeProps,
-		  code           & Code);
+		  code           & Code,
+		  CodeStats      & Stats);
 
   void enterProgram(AslParser::ProgramContext *ctx);
   void exitProgram(AslParser::ProgramContext *ctx);
@@ -152,8 +159,17 @@ private:
   SymTable        & Symbols;
   TreeDecoration  & Decorations;
   code            & Code;
+  CodeStats       & Stats;
   counters          codeCounters;
 
+  // Compile-time value of the constant expressions
+  std::map<antlr4::ParserRuleContext *, ConstValue> ConstDecorations;
+
+  // Temporal holding the base address of each array parameter used in
+  // the current function: the binding of a parameter never changes,
+  // so it is loaded once, at the entry of the function
+  std::map<std::string, std::string> ArrayParamBases;
+
   // Getters for the necessary tree node atributes:
   //   Scope, Type, Addr, Offset and Code
   SymTable::ScopeId getScopeDecor  (antlr4::ParserRuleContext *ctx);
@@ -168,4 +184,39 @@ private:
   void putOffsetDecor (antlr4::ParserRuleContext *ctx, const std::string & o);
   void putCodeDecor   (antlr4::ParserRuleContext *ctx, const instructionList & c);
 
+  // Getter and setter for the constant value of an expression. The
+  // getter returns false if it is not known at compile time
+  bool getConstDecor  (antlr4::ParserRuleContext *ctx, ConstValue & v);
+  void putConstDecor  (antlr4::ParserRuleContext *ctx, const ConstValue & v);
+
+  // Constant folding: evaluates the binary operator 'op' (as written
+  // in ASL) on c0 and c1 with the same t-code instructions it is
+  // compiled to, int2float CAST included. Returns false if it can not
+  // be folded (e.g. a division by zero, left for the VM)
+  bool foldBinary     (const std::string & op, bool isFloat,
+                       ConstValue c0, ConstValue c1, ConstValue & c);
+  // Decorates ctx as the constant c: its code just loads c into a new
+  // temporal. Returns false if c has no literal (nothing is decorated)
+  bool putFoldedDecor (antlr4::ParserRuleContext *ctx, const ConstValue & c);
+  // Code of the int2float CAST of the value of ctx into tempF: a FLOAD
+  // of the converted literal if the value is known at compile time
+  instructionList int2float (antlr4::ParserRuleContext *ctx, const std::string & tempF);
+  // The temporal with the base address of the array parameter param
+  // (see ArrayParamBases)
+  std::string getArrayParamBase (const std::string & param);
+
+  // Code of the condition ctx (of an if/while) that jumps to label
+  // when its value is jumpWhen, and falls through otherwise. Relational
+  // operators are compared and branched on directly (with the operands
+  // swapped instead of a NOT), and and/or/not become jumps, so no
+  // boolean is built only to be tested
+  instructionList branchIf (AslParser::ExprContext *ctx, bool jumpWhen,
+                            const std::string & label);
+  // A copy of code with suffix added to the labels it defines (and
+  // to its jumps to them), to repeat it in the same subroutine
+  instructionList relabel  (const instructionList & code, const std::string & suffix);
+  // True if ctx is (in parenthesis) a != relational, better tested
+  // with the branch sense inverted
+  bool isNotEqual          (AslParser::ExprContext *ctx);
+
 };
@@ -0,0 +1,108 @@
+#include "CodeOptimizer.h"
+
+#include "../common/code.h"
+#include "BranchSimplification.h"
+#include "CodeStats.h"
+#include "ConstantPropagation.h"
+#include "ControlFlowGraph.h"
+#include "CopyPropagation.h"
+#include "DeadCodeElimination.h"
+#include "DeadStoreElimination.h"
+#include "InductionVariables.h"
+#include "Inliner.h"
+#include "LoopInvariantCodeMotion.h"
+#include "PeepholeOptimizer.h"
+#include "RedundantLoadElimination.h"
+#include "SSAForm.h"
+#include "TailCallElimination.h"
+#include "TemporalRenaming.h"
+#include "ValueNumbering.h"
+
+#include <functional>
+#include <map>
+#include <set>
+#include <vector>
+
+// using namespace std;
+
+
+// Constructor
+CodeOptimizer::CodeOptimizer(code & Code, CodeStats & Stats, int inlineLimit, int inlineGrowth) :
+  Code{Code},
+  Stats{Stats},
+  inlineLimit{inlineLimit},
+  inlineGrowth{inlineGrowth} {
+}
+
+void CodeOptimizer::optimize() {
+  // callees before callers (in a recursion, the first one reached last)
+  std::map<std::string, subroutine *> byName;
+  for (auto & subr : Code.subroutines) byName[subr.name] = &subr;
+  std::vector<subroutine *> order;
+  std::set<std::string>     visited;
+  std::function<void(subroutine &)> visit = [&](subroutine & subr) {
+    if (not visited.insert(subr.name).second) return;
+    for (auto & instr : subr.instructions)
+      if (instr.oper == "CALL" and byName.count(instr.arg1)) visit(*byName[instr.arg1]);
+    order.push_back(&subr);
+  };
+  for (auto & subr : Code.subroutines) visit(subr);
+
+  // a callee without tail calls to itself is a loop, and may be inlined
+  TailCallElimination tailCalls(Stats);
+  Inliner             inliner(Code, Stats, inlineLimit, inlineGrowth);
+  for (subroutine * subr : order) {
+    tailCalls.run(*subr);
+    if (inlineLimit > 0) inliner.run(*subr);
+    optimizeSubroutine(*subr);
+  }
+}
+
+void CodeOptimizer::optimizeSubroutine(subroutine & subr) {
+  PeepholeOptimizer peephole(Stats);
+  peephole.run(subr);
+  ConstantPropagation constants(Stats);
+  constants.run(subr);
+  BranchSimplification branches(Stats);
+  branches.run(subr);
+  CopyPropagation copies(Stats);
+  copies.run(subr);
+
+  // in SSA form: the copies left are folded, and the operations
+  // already computed (and the array elements already read or written)
+  // become copies too
+  ControlFlowGraph cfg(subr.instructions);
+  SSAForm          ssa(subr, cfg);
+  ssa.construct();
+  int phis = 0;
+  for (auto & blockPhis : ssa.phis) phis += blockPhis.size();
+  Stats.addCounter(subr.name, "ssa.phis", phis);
+  Stats.addCounter(subr.name, "ssa.copies_folded", ssa.foldCopies());
+  ValueNumbering values(Stats);
+  if (values.run(subr.name, cfg, ssa) > 0)
+    Stats.addCounter(subr.name, "ssa.copies_folded", ssa.foldCopies());
+  RedundantLoadElimination loads(Stats);
+  if (loads.run(subr, cfg, ssa) > 0)
+    Stats.addCounter(subr.name, "ssa.copies_folded", ssa.foldCopies());
+  Stats.addCounter(subr.name, "ssa.copies_inserted", ssa.destruct());
+  subr.set_instructions(cfg.lower());
+
+  LoopInvariantCodeMotion invariants(Stats);
+  invariants.run(subr);
+  DeadStoreElimination deadStores(Stats);
+  deadStores.run(subr);
+  DeadCodeElimination deadCode(Stats);
+  deadCode.run(subr);
+  // on the live code only: a dead multiplication would be reduced to
+  // an increment that keeps itself alive
+  InductionVariables inductionVars(Stats);
+  if (inductionVars.run(subr)) {
+    copies.run(subr);
+    deadCode.run(subr);
+  }
+  TemporalRenaming temporals(Stats);
+  temporals.run(subr);
+  branches.run(subr);
+  // the copies between temporals that now share a name
+  peephole.run(subr);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class CodeOptimizer: runs the optimization passes (-O) on the code
+// generated by the CodeGenListener, one subroutine at a time, callees
+// before their callers: the small callees are already optimized (and
+// their tail calls to themselves turned into loops) when the Inliner
+// copies them into a caller. What each pass does is
+// counted in the CodeStats, under the pass name.
+
+class CodeOptimizer {
+
+public:
+
+  // Constructor: the Inliner copies callees of at most inlineLimit
+  // instructions (none if 0), and a caller grows at most inlineGrowth
+  CodeOptimizer(code & Code, CodeStats & Stats, int inlineLimit = 20, int inlineGrowth = 200);
+
+  // Optimizes every subroutine of the code
+  void optimize();
+
+private:
+
+  // Attributes
+  code      & Code;
+  CodeStats & Stats;
+  int         inlineLimit;
+  int         inlineGrowth;
+
+  // Runs the passes on one subroutine
+  void optimizeSubroutine(subroutine & subr);
+
+};  // class CodeOptimizer
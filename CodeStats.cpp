@@ -0,0 +1,52 @@
+#include "CodeStats.h"
+
+#include "../common/code.h"
+
+#include <set>
+
+// using namespace std;
+
+
+// Constructor
+CodeStats::CodeStats() {
+}
+
+void CodeStats::addCounter(const std::string & subrName, const std::string & key, int n) {
+  subrCounters[subrName][key] += n;
+}
+
+void CodeStats::collect(const code & Code) {
+  for (auto & subr : Code.subroutines) {
+
+    std::map<std::string, int> & c = subrCounters[subr.name];
+    std::set<std::string> temps;
+
+    // counters derived from the code are recomputed from scratch
+    for (auto it = c.begin(); it != c.end(); )
+      it = (it->first.compare(0, 3, "op.") == 0) ? c.erase(it) : ++it;
+    c["instructions"] = 0;
+    c["labels"]       = 0;
+    c["calls"]        = 0;
+    // make sure the codegen counters show up, even when they are zero
+    c["frame_size"]   += 0;
+    c["array_copies"] += 0;
+
+    for (auto & instr : subr.instructions) {
+      ++c["instructions"];
+      ++c["op." + instr.oper];
+      if (instr.oper == "LABEL") ++c["labels"];
+      if (instr.oper == "CALL")  ++c["calls"];
+
+      // temporaries are the only names starting with '%'
+      for (const std::string * arg : {&instr.arg1, &instr.arg2, &instr.arg3})
+        if (not arg->empty() and (*arg)[0] == '%') temps.insert(*arg);
+    }
+    c["temps"] = temps.size();
+  }
+}
+
+void CodeStats::print(std::ostream & os) const {
+  for (auto & subr : subrCounters)
+    for (auto & counter : subr.second)
+      os << subr.first << " " << counter.first << " " << counter.second << std::endl;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../common/code.h"
+
+#include <map>
+#include <ostream>
+#include <string>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class CodeStats: per-subroutine statistics of the generated t-code.
+// Some counters can only be known while generating the code (frame
+// size, array copies), so the CodeGenListener adds them as it goes.
+// The rest are computed from the final instructions of each
+// subroutine by collect(). The report printed by print() has one
+// line per counter, "<subroutine> <counter> <value>", sorted by
+// subroutine and counter name so two reports can be diffed.
+
+class CodeStats {
+
+public:
+
+  // Constructor
+  CodeStats();
+
+  // Adds n to the counter 'key' of the subroutine 'subrName'
+  void addCounter(const std::string & subrName, const std::string & key, int n = 1);
+
+  // Computes the counters derived from the instructions of every
+  // subroutine in Code: instructions by opcode, temporaries, labels
+  // and calls
+  void collect(const code & Code);
+
+  // Prints all the counters, one per line
+  void print(std::ostream & os) const;
+
+private:
+
+  // Counters of each subroutine, both maps sorted by name
+  std::map<std::string, std::map<std::string, int>> subrCounters;
+
+};  // class CodeStats
@@ -0,0 +1,200 @@
+#include "ConstValue.h"
+
+#include "../common/code.h"
+
+#include <climits>    // INT_MIN, INT_MAX
+#include <cmath>      // std::isfinite, std::signbit
+#include <cstdint>    // std::int64_t, std::uint32_t
+#include <cstdio>     // std::snprintf
+#include <cstdlib>    // std::strtof, std::strtoll
+
+// using namespace std;
+
+
+// Ints of the VM are 32 bits and wrap around on overflow
+static int wrapInt(std::int64_t v) {
+  return static_cast<int>(static_cast<std::uint32_t>(v));
+}
+
+// Escape sequences of ASL chars (ESC_SEQ in Asl.g4) and their codes
+static const char escapes[][2] = { {'n', '\n'}, {'t', '\t'}, {'b', '\b'}, {'f', '\f'},
+                                   {'r', '\r'}, {'"', '"'}, {'\'', '\''}, {'\\', '\\'} };
+
+ConstValue ConstValue::fromInt(int v) {
+  ConstValue c;
+  c.kind = INT;
+  c.i = v;
+  return c;
+}
+
+ConstValue ConstValue::fromFloat(float v) {
+  ConstValue c;
+  c.kind = FLOAT;
+  c.f = v;
+  return c;
+}
+
+ConstValue ConstValue::fromChar(int code) {
+  ConstValue c;
+  c.kind = CHAR;
+  c.i = code;
+  return c;
+}
+
+bool ConstValue::fromLiteral(const std::string & oper, const std::string & lit, ConstValue & v) {
+  if (lit.empty()) return false;
+
+  if (oper == "ILOAD" or oper == "LOAD") {
+    // a LOAD of a name is a copy, not a constant
+    std::size_t first = (lit[0] == '-') ? 1 : 0;
+    if (lit.size() == first or lit.find_first_not_of("0123456789", first) != std::string::npos)
+      return false;
+    long long n = std::strtoll(lit.c_str(), nullptr, 10);
+    if (n < INT_MIN or n > INT_MAX) return false;
+    v = fromInt(int(n));
+    return true;
+  }
+  if (oper == "FLOAD") {
+    char * end;
+    float x = std::strtof(lit.c_str(), &end);
+    if (*end != '\0') return false;
+    v = fromFloat(x);
+    return true;
+  }
+  if (oper == "CHLOAD") {
+    if (lit.size() == 1) {
+      v = fromChar((unsigned char) lit[0]);
+      return true;
+    }
+    if (lit.size() == 2 and lit[0] == '\\') {
+      for (auto & e : escapes)
+        if (lit[1] == e[0]) {
+          v = fromChar(e[1]);
+          return true;
+        }
+    }
+  }
+  return false;
+}
+
+bool ConstValue::evaluate(const std::string & oper, const ConstValue & a,
+                          const ConstValue & b, ConstValue & r) {
+  if (oper == "LOAD") {
+    r = a;
+    return true;
+  }
+
+  // INTEGER
+  if (oper == "ADD" or oper == "SUB" or oper == "MUL" or oper == "DIV") {
+    if (a.kind != INT or b.kind != INT) return false;
+    std::int64_t x = a.i, y = b.i;
+    if (oper == "ADD")      r = fromInt(wrapInt(x + y));
+    else if (oper == "SUB") r = fromInt(wrapInt(x - y));
+    else if (oper == "MUL") r = fromInt(wrapInt(x * y));
+    else {
+      // the VM traps, keep it at run time
+      if (y == 0 or (x == INT_MIN and y == -1)) return false;
+      r = fromInt(int(x / y));   // truncates towards zero, as C++
+    }
+    return true;
+  }
+  if (oper == "NEG") {
+    if (a.kind != INT or a.i == INT_MIN) return false;
+    r = fromInt(-a.i);
+    return true;
+  }
+
+  // FLOAT
+  if (oper == "FADD" or oper == "FSUB" or oper == "FMUL" or oper == "FDIV") {
+    if (a.kind != FLOAT or b.kind != FLOAT) return false;
+    if (oper == "FADD")      r = fromFloat(a.f + b.f);
+    else if (oper == "FSUB") r = fromFloat(a.f - b.f);
+    else if (oper == "FMUL") r = fromFloat(a.f * b.f);
+    else                     r = fromFloat(a.f / b.f);
+    return std::isfinite(r.f);
+  }
+  if (oper == "FNEG") {
+    if (a.kind != FLOAT) return false;
+    r = fromFloat(-a.f);
+    return true;
+  }
+  if (oper == "FLOAT") {
+    if (a.kind != INT) return false;
+    r = fromFloat(float(a.i));
+    return true;
+  }
+
+  // RELATIONAL (ints, bools and chars / floats)
+  if (oper == "EQ" or oper == "LT" or oper == "LE") {
+    if (a.kind != b.kind or a.kind == FLOAT) return false;
+    if (oper == "EQ")      r = fromInt(a.i == b.i);
+    else if (oper == "LT") r = fromInt(a.i <  b.i);
+    else                   r = fromInt(a.i <= b.i);
+    return true;
+  }
+  if (oper == "FEQ" or oper == "FLT" or oper == "FLE") {
+    if (a.kind != FLOAT or b.kind != FLOAT) return false;
+    if (oper == "FEQ")      r = fromInt(a.f == b.f);
+    else if (oper == "FLT") r = fromInt(a.f <  b.f);
+    else                    r = fromInt(a.f <= b.f);
+    return true;
+  }
+
+  // LOGICAL
+  if (oper == "AND" or oper == "OR") {
+    if (a.kind != INT or b.kind != INT) return false;
+    r = fromInt(oper == "AND" ? (a.i and b.i) : (a.i or b.i));
+    return true;
+  }
+  if (oper == "NOT") {
+    if (a.kind != INT) return false;
+    r = fromInt(not a.i);
+    return true;
+  }
+
+  return false;
+}
+
+bool ConstValue::load(const std::string & dst, instructionList & code) const {
+  if (kind == INT) {
+    if (i == INT_MIN) return false;
+    code = code || instruction::ILOAD(dst, std::to_string(i < 0 ? -i : i));
+    if (i < 0) code = code || instruction::NEG(dst, dst);
+    return true;
+  }
+
+  if (kind == FLOAT) {
+    if (not std::isfinite(f)) return false;
+    // 9 significant digits are enough to read back the same float
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", double(std::fabs(f)));
+    std::string lit = buffer;
+    if (lit.find('e') != std::string::npos) return false;
+    if (lit.find('.') == std::string::npos) lit += ".0";
+    code = code || instruction::FLOAD(dst, lit);
+    if (std::signbit(f)) code = code || instruction::FNEG(dst, dst);
+    return true;
+  }
+
+  /* kind == CHAR */
+  std::string lit;
+  for (auto & e : escapes)
+    if (i == e[1] and e[0] != '"') lit = std::string("\\") + e[0];
+  if (lit.empty()) {
+    if (i < 32 or i > 126) return false;
+    lit = std::string(1, char(i));
+  }
+  code = code || instruction::CHLOAD(dst, lit);
+  return true;
+}
+
+bool ConstValue::operator==(const ConstValue & other) const {
+  if (kind != other.kind) return false;
+  // compare the bits, so -0.0 and 0.0 are different constants
+  return kind == FLOAT ? (f == other.f and std::signbit(f) == std::signbit(other.f))
+                       : i == other.i;
+}
+
+bool ConstValue::operator!=(const ConstValue & other) const {
+  return not (*this == other);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../common/code.h"
+
+#include <string>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class ConstValue: a value known at compile time, with the same
+// representation the t-code VM uses: 32-bit ints (bools are 0/1),
+// single precision floats and chars. It is used to fold constant
+// expressions, so evaluate() must give exactly what the VM would
+// compute for the instruction, and refuses to fold anything that
+// would trap at run time (division by zero, INT_MIN / -1).
+
+class ConstValue {
+
+public:
+
+  enum Kind { INT, FLOAT, CHAR };
+
+  Kind  kind = INT;
+  int   i    = 0;     // INT value or CHAR code
+  float f    = 0;     // FLOAT value
+
+  static ConstValue fromInt   (int v);
+  static ConstValue fromFloat (float v);
+  static ConstValue fromChar  (int c);
+
+  // Value of the literal loaded by an ILOAD, FLOAD or CHLOAD
+  // instruction, or by a LOAD of an immediate ("0"/"1" bools).
+  // Returns false if oper/lit is not such a load
+  static bool fromLiteral(const std::string & oper, const std::string & lit, ConstValue & v);
+
+  // Evaluates the t-code instruction 'oper' on a (and b if binary)
+  // and leaves the result in r. Returns false if oper is not a pure
+  // operation, the operand kinds do not match, or it would trap
+  static bool evaluate(const std::string & oper, const ConstValue & a,
+                       const ConstValue & b, ConstValue & r);
+
+  // Appends to code the instructions that load this value into dst
+  // (a negative number is loaded as its absolute value and negated).
+  // Returns false if the value has no literal the VM can read
+  bool load(const std::string & dst, instructionList & code) const;
+
+  bool operator==(const ConstValue & other) const;
+  bool operator!=(const ConstValue & other) const;
+
+};  // class ConstValue
@@ -0,0 +1,205 @@
+#include "ConstantPropagation.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ConstValue.h"
+#include "ControlFlowGraph.h"
+#include "InstructionInfo.h"
+
+#include <algorithm>  // std::equal
+#include <deque>
+#include <set>
+#include <utility>
+#include <vector>
+
+// using namespace std;
+
+
+// Constructor
+ConstantPropagation::ConstantPropagation(CodeStats & Stats) :
+  Stats{Stats} {
+}
+
+bool ConstantPropagation::run(subroutine & subr) {
+  ControlFlowGraph cfg(subr.instructions);
+  int n = cfg.blocks.size();
+  if (n == 0) return false;
+
+  std::vector<bool>            executable(n, false), visited(n, false);
+  std::vector<ConstMap>        in(n), out(n);
+  std::set<std::pair<int,int>> executableEdges;
+
+  // Propagation: a block is (re)visited when one of its incoming
+  // executable edges is new or carries new values
+  std::deque<int> pending = {0};
+  executable[0] = true;
+  while (not pending.empty()) {
+    int b = pending.front();
+    pending.pop_front();
+
+    // merge what comes through the executable edges already visited.
+    // Nothing is known at the entry of the subroutine
+    ConstMap consts;
+    bool     first = true;
+    if (b != 0) {
+      for (int p : cfg.blocks[b].preds) {
+        if (not visited[p] or not executableEdges.count({p, b})) continue;
+        if (first) consts = out[p];
+        else       meet(consts, out[p]);
+        first = false;
+      }
+    }
+    in[b] = consts;
+    for (auto & instr : cfg.blocks[b].instructions)
+      transfer(instr, consts);
+
+    if (visited[b] and consts.size() == out[b].size() and
+        std::equal(consts.begin(), consts.end(), out[b].begin()))
+      continue;
+    visited[b] = true;
+    out[b]     = consts;
+
+    // successors reachable from b: only one arm of a FJUMP on a constant
+    const instruction & last = cfg.blocks[b].instructions.back();
+    std::vector<int>    succs = cfg.blocks[b].succs;
+    auto cond = consts.find(last.arg1);
+    if (last.oper == "FJUMP" and cond != consts.end() and succs.size() == 2)
+      succs = {cond->second.i ? succs[0] : succs[1]};
+    for (int s : succs) {
+      executableEdges.insert({b, s});
+      executable[s] = true;
+      pending.push_back(s);
+    }
+  }
+
+  // Rewriting, with the constants known at the entry of each block
+  int folded = 0, branches = 0, deadBlocks = 0, simplified = 0;
+  for (int b = 0; b < n; ++b) {
+    if (not executable[b]) {
+      ++deadBlocks;
+      continue;
+    }
+    ConstMap consts = in[b];
+    instructionList & instrs = cfg.blocks[b].instructions;
+    for (auto it = instrs.begin(); it != instrs.end(); ) {
+      const instruction & instr = *it;
+      std::string def = InstructionInfo::getDef(instr);
+      ConstValue  v;
+
+      // FJUMP on a known condition
+      if (instr.oper == "FJUMP" and consts.count(instr.arg1)) {
+        ++branches;
+        if (consts[instr.arg1].i) it = instrs.erase(it);
+        else                      *it++ = instruction::UJUMP(instr.arg2);
+        continue;
+      }
+
+      // an operation with a constant result, except the loads of
+      // literals (ILOAD, LOAD t 1) and the NEG/FNEG of a negative one
+      bool isLoadOfLiteral = (instr.oper == "LOAD" and not InstructionInfo::isName(instr.arg2)) or
+                             instr.oper == "ILOAD" or instr.oper == "FLOAD" or instr.oper == "CHLOAD" or
+                             ((instr.oper == "NEG" or instr.oper == "FNEG") and instr.arg2 == def);
+      instructionList load;
+      if (not def.empty() and InstructionInfo::isPure(instr) and not isLoadOfLiteral and
+          evaluate(instr, consts, v) and v.load(def, load)) {
+        ++folded;
+        transfer(instr, consts);
+        it = instrs.erase(it);
+        instrs.insert(it, load.begin(), load.end());
+        continue;
+      }
+
+      if (simplify(*it, consts)) ++simplified;
+      transfer(*it, consts);
+      ++it;
+    }
+  }
+  // the dead blocks, and the ones left empty (a FJUMP alone in its
+  // block, as in a and b, on a known condition)
+  std::vector<bool> keep = executable;
+  for (int b = 0; b < n; ++b)
+    if (cfg.blocks[b].instructions.empty()) keep[b] = false;
+  cfg.removeBlocks(keep);
+
+  Stats.addCounter(subr.name, "sccp.folded", folded);
+  Stats.addCounter(subr.name, "sccp.branches", branches);
+  Stats.addCounter(subr.name, "sccp.dead_blocks", deadBlocks);
+  Stats.addCounter(subr.name, "sccp.simplified", simplified);
+  if (folded + branches + deadBlocks + simplified == 0) return false;
+  subr.set_instructions(cfg.lower());
+  return true;
+}
+
+bool ConstantPropagation::evaluate(const instruction & instr, const ConstMap & consts, ConstValue & v) {
+  // loads of literals
+  if (ConstValue::fromLiteral(instr.oper, instr.arg2, v)) return true;
+  if (not InstructionInfo::isPure(instr)) return false;
+
+  // operations with constant operands (a literal operand is constant too)
+  auto operand = [&](const std::string & arg, ConstValue & c) -> bool {
+    if (not InstructionInfo::isName(arg)) return ConstValue::fromLiteral("LOAD", arg, c);
+    auto it = consts.find(arg);
+    if (it == consts.end()) return false;
+    c = it->second;
+    return true;
+  };
+  ConstValue a, b;
+  if (not operand(instr.arg2, a)) return false;
+  if (not instr.arg3.empty() and not operand(instr.arg3, b)) return false;
+  return ConstValue::evaluate(instr.oper, a, instr.arg3.empty() ? a : b, v);
+}
+
+bool ConstantPropagation::simplify(instruction & instr, const ConstMap & consts) {
+  const std::string & op = instr.oper;
+  bool commutative = op == "ADD" or op == "MUL" or op == "AND" or op == "OR";
+  if (not commutative and op != "SUB" and op != "DIV") return false;
+
+  auto constant = [&](const std::string & arg, int & c) -> bool {
+    ConstValue v;
+    if (not InstructionInfo::isName(arg)) {
+      if (not ConstValue::fromLiteral("LOAD", arg, v)) return false;
+    }
+    else {
+      auto it = consts.find(arg);
+      if (it == consts.end()) return false;
+      v = it->second;
+    }
+    if (v.kind != ConstValue::INT) return false;
+    c = v.i;
+    return true;
+  };
+  // x: the operand that is not known, c: the constant one
+  std::string dst = instr.arg1, x = instr.arg2;
+  int c;
+  if (not constant(instr.arg3, c)) {
+    if (not commutative or not constant(instr.arg2, c)) return false;
+    x = instr.arg3;
+  }
+
+  bool identity = ((op == "ADD" or op == "SUB" or op == "OR") and c == 0) or
+                  ((op == "MUL" or op == "DIV" or op == "AND") and c == 1);
+  if      (identity)                   instr = instruction::LOAD(dst, x);
+  else if (op == "MUL" and c == 0)     instr = instruction::ILOAD(dst, "0");
+  else if (op == "AND" and c == 0)     instr = instruction::ILOAD(dst, "0");
+  else if (op == "OR"  and c == 1)     instr = instruction::ILOAD(dst, "1");
+  else if (op == "MUL" and c == 2)     instr = instruction::ADD(dst, x, x);
+  else if (op == "MUL" and c == -1)    instr = instruction::NEG(dst, x);
+  else return false;
+  return true;
+}
+
+void ConstantPropagation::transfer(const instruction & instr, ConstMap & consts) {
+  std::string def = InstructionInfo::getDef(instr);
+  if (def.empty()) return;
+  ConstValue v;
+  if (evaluate(instr, consts, v)) consts[def] = v;
+  else                            consts.erase(def);
+}
+
+void ConstantPropagation::meet(ConstMap & consts, const ConstMap & other) {
+  for (auto it = consts.begin(); it != consts.end(); ) {
+    auto o = other.find(it->first);
+    if (o == other.end() or o->second != it->second) it = consts.erase(it);
+    else ++it;
+  }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ConstValue.h"
+
+#include <map>
+#include <string>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class ConstantPropagation: sparse conditional constant propagation
+// over the control flow graph of a subroutine. Starting from the
+// entry, only the edges that can be taken are followed: a FJUMP on a
+// constant condition has one executable successor, so the values
+// known on the other arm do not spoil the merge. Once the constants
+// are known:
+//   - an instruction whose result is constant becomes a load of it
+//   - a FJUMP on a known condition becomes a UJUMP (or disappears)
+//   - the blocks that can never execute (dead arms) are removed
+//   - an integer or boolean operation with one constant operand is
+//     simplified when the constant is an identity (x+0, x-0, x*1,
+//     x/1, x and true, x or false become a copy of x), absorbs x
+//     (x*0, x and false, x or true become the constant), or gives a
+//     cheaper operation (x*2 becomes x+x, x*-1 becomes -x). A DIV by
+//     -1 stays: it traps on the smallest int
+// The instructions feeding the folded ones are left for the dead
+// code elimination.
+
+class ConstantPropagation {
+
+public:
+
+  // Constructor
+  ConstantPropagation(CodeStats & Stats);
+
+  // Runs the pass on subr. Returns true if the code changed
+  bool run(subroutine & subr);
+
+private:
+
+  // Attributes
+  CodeStats & Stats;
+
+  // Names with a constant value at some point of the code; the rest
+  // are not constant (or not known yet)
+  typedef std::map<std::string, ConstValue> ConstMap;
+
+  // Value of the name defined by instr, if it is constant
+  static bool evaluate(const instruction & instr, const ConstMap & consts, ConstValue & v);
+
+  // Rewrites instr into a cheaper instruction, if one of its operands
+  // is a constant that allows it. Returns true if instr changed
+  static bool simplify(instruction & instr, const ConstMap & consts);
+
+  // Updates consts with the effect of instr
+  static void transfer(const instruction & instr, ConstMap & consts);
+
+  // Keeps only the names with the same value in both maps
+  static void meet(ConstMap & consts, const ConstMap & other);
+
+};  // class ConstantPropagation
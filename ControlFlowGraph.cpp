@@ -0,0 +1,212 @@
+#include "ControlFlowGraph.h"
+
+#include "../common/code.h"
+#include "InstructionInfo.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// using namespace std;
+
+
+// Constructor
+ControlFlowGraph::ControlFlowGraph(const instructionList & code) {
+  bool onlyLabels = false;   // the current block has only LABELs so far
+  bool ended      = true;    // the current block ends with a jump/RETURN
+  for (auto & instr : code) {
+    bool isLabel = InstructionInfo::isLabel(instr);
+    if (ended or (isLabel and not onlyLabels)) {
+      blocks.push_back(BasicBlock());
+      onlyLabels = true;
+    }
+    blocks.back().instructions.push_back(instr);
+    onlyLabels = onlyLabels and isLabel;
+    ended      = InstructionInfo::endsBlock(instr);
+  }
+  computeEdges();
+}
+
+void ControlFlowGraph::computeEdges() {
+  std::unordered_map<std::string, int> blockOfLabel;
+  for (int b = 0; b < int(blocks.size()); ++b) {
+    blocks[b].succs.clear();
+    blocks[b].preds.clear();
+    for (auto & instr : blocks[b].instructions) {
+      if (not InstructionInfo::isLabel(instr)) break;
+      blockOfLabel[InstructionInfo::getLabel(instr)] = b;
+    }
+  }
+
+  for (int b = 0; b < int(blocks.size()); ++b) {
+    std::vector<int> & succs = blocks[b].succs;
+    const instruction & last = blocks[b].instructions.back();
+    if (InstructionInfo::fallsThrough(last) and b+1 < int(blocks.size()))
+      succs.push_back(b+1);
+    if (InstructionInfo::isJump(last)) {
+      auto it = blockOfLabel.find(InstructionInfo::getLabel(last));
+      if (it != blockOfLabel.end() and (succs.empty() or succs[0] != it->second))
+        succs.push_back(it->second);
+    }
+    for (int s : succs) blocks[s].preds.push_back(b);
+  }
+  idom.clear();
+  loops.clear();
+  loopOf.clear();
+}
+
+void ControlFlowGraph::removeBlocks(const std::vector<bool> & keep) {
+  std::vector<BasicBlock> kept;
+  for (int b = 0; b < int(blocks.size()); ++b)
+    if (keep[b]) kept.push_back(std::move(blocks[b]));
+  blocks.swap(kept);
+  computeEdges();
+}
+
+instructionList ControlFlowGraph::lower() const {
+  instructionList code;
+  for (auto & block : blocks)
+    code.insert(code.end(), block.instructions.begin(), block.instructions.end());
+  return code;
+}
+
+std::vector<int> ControlFlowGraph::reversePostorder() const {
+  std::vector<int> order;
+  if (blocks.empty()) return order;
+
+  // iterative depth first search: (block, next successor to visit)
+  std::vector<bool>                visited(blocks.size(), false);
+  std::vector<std::pair<int,int>>  stack = {{0, 0}};
+  visited[0] = true;
+  while (not stack.empty()) {
+    int b = stack.back().first;
+    int i = stack.back().second++;
+    if (i < int(blocks[b].succs.size())) {
+      int s = blocks[b].succs[i];
+      if (not visited[s]) {
+        visited[s] = true;
+        stack.push_back({s, 0});
+      }
+    }
+    else {
+      order.push_back(b);
+      stack.pop_back();
+    }
+  }
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+// Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm"
+void ControlFlowGraph::computeDominators() {
+  idom.assign(blocks.size(), -1);
+  if (blocks.empty()) return;
+  std::vector<int> rpo = reversePostorder();
+  std::vector<int> number(blocks.size(), -1);   // position in rpo
+  for (int i = 0; i < int(rpo.size()); ++i) number[rpo[i]] = i;
+
+  auto intersect = [&](int a, int b) {
+    while (a != b) {
+      while (number[a] > number[b]) a = idom[a];
+      while (number[b] > number[a]) b = idom[b];
+    }
+    return a;
+  };
+
+  idom[0] = 0;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int i = 1; i < int(rpo.size()); ++i) {
+      int b = rpo[i], newIdom = -1;
+      for (int p : blocks[b].preds) {
+        if (idom[p] == -1) continue;
+        newIdom = (newIdom == -1) ? p : intersect(p, newIdom);
+      }
+      if (newIdom != idom[b]) {
+        idom[b] = newIdom;
+        changed = true;
+      }
+    }
+  }
+}
+
+bool ControlFlowGraph::dominates(int a, int b) const {
+  if (idom[b] == -1) return false;
+  while (b != a and b != 0) b = idom[b];
+  return b == a;
+}
+
+void ControlFlowGraph::computeLoops() {
+  computeDominators();
+  loops.clear();
+  loopOf.assign(blocks.size(), -1);
+
+  // one loop per header, with the blocks of all its back edges
+  std::vector<int> loopOfHeader(blocks.size(), -1);
+  for (int b = 0; b < int(blocks.size()); ++b) {
+    for (int h : blocks[b].succs) {
+      if (not dominates(h, b)) continue;
+      if (loopOfHeader[h] == -1) {
+        loopOfHeader[h] = loops.size();
+        loops.push_back(Loop{h, {h}, -1, 0});
+      }
+      Loop & loop = loops[loopOfHeader[h]];
+      std::vector<bool> inLoop(blocks.size(), false);
+      for (int x : loop.blocks) inLoop[x] = true;
+      std::vector<int> pending;
+      if (not inLoop[b]) {
+        inLoop[b] = true;
+        loop.blocks.push_back(b);
+        pending.push_back(b);
+      }
+      while (not pending.empty()) {
+        int x = pending.back();
+        pending.pop_back();
+        for (int p : blocks[x].preds) {
+          if (inLoop[p] or idom[p] == -1) continue;
+          inLoop[p] = true;
+          loop.blocks.push_back(p);
+          pending.push_back(p);
+        }
+      }
+    }
+  }
+
+  // outer loops first: a loop contains the ones with more blocks
+  std::sort(loops.begin(), loops.end(), [](const Loop & a, const Loop & b) {
+    return a.blocks.size() > b.blocks.size() or
+           (a.blocks.size() == b.blocks.size() and a.header < b.header);
+  });
+  for (int l = 0; l < int(loops.size()); ++l) {
+    Loop & loop = loops[l];
+    std::sort(loop.blocks.begin(), loop.blocks.end());
+    loop.parent = loopOf[loop.header];
+    loop.depth  = (loop.parent == -1) ? 1 : loops[loop.parent].depth + 1;
+    for (int b : loop.blocks) loopOf[b] = l;
+  }
+}
+
+int ControlFlowGraph::loopDepth(int b) const {
+  return (loopOf.empty() or loopOf[b] == -1) ? 0 : loops[loopOf[b]].depth;
+}
+
+bool ControlFlowGraph::canInsertPreheader(int l) const {
+  const Loop & loop = loops[l];
+  int header = loop.header, before = header - 1;
+  std::vector<bool> inLoop(blocks.size(), false);
+  for (int b : loop.blocks) inLoop[b] = true;
+  if (before < 0 or inLoop[before]) return false;
+  for (int p : blocks[header].preds)
+    if (not inLoop[p] and p != before) return false;
+  const instruction & last = blocks[before].instructions.back();
+  if (not InstructionInfo::fallsThrough(last)) return false;
+  if (InstructionInfo::isJump(last)) {
+    for (auto & instr : blocks[header].instructions)
+      if (InstructionInfo::isLabel(instr) and
+          InstructionInfo::getLabel(instr) == InstructionInfo::getLabel(last))
+        return false;
+  }
+  return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../common/code.h"
+
+#include <vector>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class ControlFlowGraph: the basic blocks of the instructions of a
+// subroutine and the edges between them. A block starts at a LABEL
+// (or right after a jump/RETURN) and keeps its LABELs as its first
+// instructions, so lower() gives back the same list of instructions
+// when nothing is changed. Blocks are kept in code order: blocks[0]
+// is the entry, and a block that falls through continues in the next
+// one. Building the blocks and the edges is linear in the number of
+// instructions; the dominators and the loops are only computed when
+// a pass asks for them.
+
+class ControlFlowGraph {
+
+public:
+
+  struct BasicBlock {
+    instructionList  instructions;
+    std::vector<int> succs;   // fall-through successor first (at most 2)
+    std::vector<int> preds;
+  };
+
+  // A natural loop: the blocks that reach a back edge into its header
+  // without going through the header
+  struct Loop {
+    int              header;
+    std::vector<int> blocks;   // in code order, the header included
+    int              parent;   // innermost loop containing it, or -1
+    int              depth;    // 1 for an outermost loop
+  };
+
+  // Constructor: splits code into basic blocks
+  ControlFlowGraph(const instructionList & code);
+
+  // Blocks in code order
+  std::vector<BasicBlock> blocks;
+
+  // Recomputes the edges, after changing the jumps of some block
+  // (the dominators and the loops have to be computed again)
+  void computeEdges();
+
+  // Removes the blocks b with keep[b] false, and recomputes the edges
+  void removeBlocks(const std::vector<bool> & keep);
+
+  // Back to a list of instructions
+  instructionList lower() const;
+
+  // Blocks reachable from the entry, in reverse postorder
+  std::vector<int> reversePostorder() const;
+
+  // Immediate dominators: idom[0] == 0, and -1 for the blocks not
+  // reachable from the entry
+  std::vector<int> idom;
+  void computeDominators();
+
+  // True if every path from the entry to b goes through a (after
+  // computeDominators)
+  bool dominates(int a, int b) const;
+
+  // Loops, outer ones before the loops they contain, and the
+  // innermost loop of each block (-1 if none)
+  std::vector<Loop> loops;
+  std::vector<int>  loopOf;
+  void computeLoops();   // computes the dominators too
+
+  // Nesting depth of the loops around block b (0 outside any loop)
+  int loopDepth(int b) const;
+
+  // True if loop l is only entered falling through from the block
+  // before its header: a block inserted at the position of the header
+  // (a preheader) runs once before the loop
+  bool canInsertPreheader(int l) const;
+
+};  // class ControlFlowGraph
@@ -0,0 +1,199 @@
+#include "CopyPropagation.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ControlFlowGraph.h"
+#include "InstructionInfo.h"
+#include "Liveness.h"
+
+#include <deque>
+#include <set>
+#include <vector>
+
+// using namespace std;
+
+
+// Number of distinct temporals in the instructions of subr
+static int countTemps(const subroutine & subr) {
+  std::set<std::string> temps;
+  for (auto & instr : subr.instructions)
+    for (auto & arg : {instr.arg1, instr.arg2, instr.arg3})
+      if (InstructionInfo::isTemp(arg)) temps.insert(arg);
+  return temps.size();
+}
+
+
+// Constructor
+CopyPropagation::CopyPropagation(CodeStats & Stats) :
+  Stats{Stats} {
+}
+
+bool CopyPropagation::run(subroutine & subr) {
+  ControlFlowGraph cfg(subr.instructions);
+  if (cfg.blocks.empty()) return false;
+
+  int tempsBefore = countTemps(subr);
+  int coalesced   = coalesce(cfg);
+  int replaced    = propagate(cfg);
+  int removed     = removeDeadCopies(cfg);
+  if (coalesced + replaced + removed == 0) return false;
+  subr.set_instructions(cfg.lower());
+
+  Stats.addCounter(subr.name, "copies.instructions_removed", coalesced + removed);
+  Stats.addCounter(subr.name, "copies.temps_removed", tempsBefore - countTemps(subr));
+  return true;
+}
+
+int CopyPropagation::coalesce(ControlFlowGraph & cfg) {
+  Liveness liveness(cfg);
+  int      coalesced = 0;
+  for (int b = 0; b < int(cfg.blocks.size()); ++b) {
+    std::vector<instruction> instrs(cfg.blocks[b].instructions.begin(),
+                                    cfg.blocks[b].instructions.end());
+    int n = instrs.size();
+
+    // names live after each instruction
+    std::vector<Liveness::NameSet> liveAfter(n);
+    Liveness::NameSet live = liveness.liveOut[b];
+    for (int i = n-1; i >= 0; --i) {
+      liveAfter[i] = live;
+      Liveness::transfer(instrs[i], live);
+    }
+
+    std::vector<bool> removed(n, false);
+    for (int i = 0; i < n; ++i) {
+      // LOAD x t, with t dead after it
+      const std::string & x = instrs[i].arg1;
+      const std::string & t = instrs[i].arg2;
+      if (not isCopy(instrs[i]) or not InstructionInfo::isTemp(t) or
+          x == t or liveAfter[i].count(t))
+        continue;
+      // the definition of t, with no use of t nor use/definition of x
+      // in between
+      for (int j = i-1; j >= 0; --j) {
+        if (removed[j]) continue;
+        if (InstructionInfo::getDef(instrs[j]) == t) {
+          instrs[j].arg1 = x;
+          removed[i]     = true;
+          ++coalesced;
+          break;
+        }
+        std::vector<std::string> uses = InstructionInfo::getUses(instrs[j]);
+        bool usesTorX = false;
+        for (auto & name : uses)
+          usesTorX = usesTorX or name == t or name == x;
+        if (usesTorX or InstructionInfo::getDef(instrs[j]) == x) break;
+      }
+    }
+
+    instructionList & block = cfg.blocks[b].instructions;
+    block.clear();
+    for (int i = 0; i < n; ++i)
+      if (not removed[i]) block.push_back(instrs[i]);
+  }
+  return coalesced;
+}
+
+int CopyPropagation::propagate(ControlFlowGraph & cfg) {
+  int n = cfg.blocks.size();
+
+  // Copies available at the entry of each block: the ones coming
+  // through every predecessor. Starting at the entry, a predecessor
+  // not visited yet (a back edge) does not spoil the merge
+  std::vector<bool>    visited(n, false);
+  std::vector<CopyMap> in(n), out(n);
+  std::deque<int>      pending = {0};
+  while (not pending.empty()) {
+    int b = pending.front();
+    pending.pop_front();
+
+    CopyMap copies;
+    bool    first = true;
+    if (b != 0) {
+      for (int p : cfg.blocks[b].preds) {
+        if (not visited[p]) continue;
+        if (first) copies = out[p];
+        else       meet(copies, out[p]);
+        first = false;
+      }
+    }
+    in[b] = copies;
+    for (auto & instr : cfg.blocks[b].instructions)
+      transfer(instr, copies);
+
+    if (visited[b] and copies == out[b]) continue;
+    visited[b] = true;
+    out[b]     = copies;
+    for (int s : cfg.blocks[b].succs)
+      pending.push_back(s);
+  }
+
+  // Rewriting of the uses (blocks never reached keep their code)
+  int replaced = 0;
+  for (int b = 0; b < n; ++b) {
+    if (not visited[b]) continue;
+    CopyMap copies = in[b];
+    for (auto & instr : cfg.blocks[b].instructions) {
+      for (std::string * arg : InstructionInfo::getUseArgs(instr)) {
+        auto it = copies.find(*arg);
+        if (it == copies.end()) continue;
+        if (InstructionInfo::isAddressArg(instr, arg) and
+            not InstructionInfo::isTemp(it->second))
+          continue;
+        *arg = it->second;
+        ++replaced;
+      }
+      transfer(instr, copies);
+    }
+  }
+  return replaced;
+}
+
+int CopyPropagation::removeDeadCopies(ControlFlowGraph & cfg) {
+  // removing a copy may leave dead the copy feeding it
+  int  removed = 0;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    Liveness liveness(cfg);
+    for (int b = 0; b < int(cfg.blocks.size()); ++b) {
+      Liveness::NameSet live   = liveness.liveOut[b];
+      instructionList & instrs = cfg.blocks[b].instructions;
+      for (auto it = instrs.end(); it != instrs.begin(); ) {
+        --it;
+        if (isCopy(*it) and (it->arg1 == it->arg2 or not live.count(it->arg1))) {
+          it = instrs.erase(it);
+          ++removed;
+          changed = true;
+          continue;
+        }
+        Liveness::transfer(*it, live);
+      }
+    }
+  }
+  return removed;
+}
+
+void CopyPropagation::transfer(const instruction & instr, CopyMap & copies) {
+  std::string def = InstructionInfo::getDef(instr);
+  if (def.empty()) return;
+  // writing def ends the copies from and into it
+  for (auto it = copies.begin(); it != copies.end(); ) {
+    if (it->first == def or it->second == def) it = copies.erase(it);
+    else ++it;
+  }
+  if (isCopy(instr) and instr.arg1 != instr.arg2)
+    copies[instr.arg1] = instr.arg2;
+}
+
+void CopyPropagation::meet(CopyMap & copies, const CopyMap & other) {
+  for (auto it = copies.begin(); it != copies.end(); ) {
+    auto o = other.find(it->first);
+    if (o == other.end() or o->second != it->second) it = copies.erase(it);
+    else ++it;
+  }
+}
+
+bool CopyPropagation::isCopy(const instruction & instr) {
+  return instr.oper == "LOAD" and InstructionInfo::isName(instr.arg2);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ControlFlowGraph.h"
+
+#include <map>
+#include <string>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class CopyPropagation: removes the copies (LOAD x y) the code
+// generator puts between the temporals and the variables:
+//   - a temporal computed only to be copied into a variable is
+//     computed directly into it ("ADD %3 a b; LOAD x %3" becomes
+//     "ADD x a b"), in the same basic block
+//   - after a copy LOAD x y, and while neither x nor y is written
+//     again on any path, the uses of x read y instead
+//   - the copies whose result is not used any more are removed
+// The base of LOADX/XLOAD and the array of ALOAD are only replaced by
+// temporals, that hold the address of the array.
+
+class CopyPropagation {
+
+public:
+
+  // Constructor
+  CopyPropagation(CodeStats & Stats);
+
+  // Runs the pass on subr. Returns true if the code changed
+  bool run(subroutine & subr);
+
+private:
+
+  // Attributes
+  CodeStats & Stats;
+
+  // Copies available at some point of the code: CopyMap[x] == y
+  // after LOAD x y
+  typedef std::map<std::string, std::string> CopyMap;
+
+  // Computes into the defining instructions the temporals that are
+  // only copied into a variable. Returns the copies removed
+  static int coalesce(ControlFlowGraph & cfg);
+
+  // Replaces the uses of copied names by their sources. Returns the
+  // args replaced
+  static int propagate(ControlFlowGraph & cfg);
+
+  // Removes the copies whose result is dead. Returns the copies removed
+  static int removeDeadCopies(ControlFlowGraph & cfg);
+
+  // Updates copies with the effect of instr
+  static void transfer(const instruction & instr, CopyMap & copies);
+
+  // Keeps only the copies in both maps
+  static void meet(CopyMap & copies, const CopyMap & other);
+
+  // True if instr is a copy between two names
+  static bool isCopy(const instruction & instr);
+
+};  // class CopyPropagation
@@ -0,0 +1,55 @@
+#include "DeadCodeElimination.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ControlFlowGraph.h"
+#include "InstructionInfo.h"
+#include "Liveness.h"
+
+// using namespace std;
+
+
+// Constructor
+DeadCodeElimination::DeadCodeElimination(CodeStats & Stats) :
+  Stats{Stats} {
+}
+
+bool DeadCodeElimination::run(subroutine & subr) {
+  ControlFlowGraph cfg(subr.instructions);
+  int removed = 0, pops = 0;
+
+  // removing an instruction may leave dead the ones feeding it, also
+  // in other blocks: repeat until nothing changes
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    Liveness liveness(cfg);
+    for (int b = 0; b < int(cfg.blocks.size()); ++b) {
+      Liveness::NameSet live   = liveness.liveOut[b];
+      instructionList & instrs = cfg.blocks[b].instructions;
+      for (auto it = instrs.end(); it != instrs.begin(); ) {
+        --it;
+        std::string def = InstructionInfo::getDef(*it);
+        if (not def.empty() and not live.count(def)) {
+          if (it->oper == "POP") {
+            *it = instruction::POP();
+            ++pops;
+          }
+          else if (not InstructionInfo::hasSideEffects(*it)) {
+            it = instrs.erase(it);
+            ++removed;
+            changed = true;
+            continue;
+          }
+        }
+        Liveness::transfer(*it, live);
+      }
+    }
+  }
+
+  Stats.addCounter(subr.name, "dce.removed", removed);
+  Stats.addCounter(subr.name, "dce.pops", pops);
+  if (removed + pops == 0) return false;
+  subr.set_instructions(cfg.lower());
+  return true;
+}
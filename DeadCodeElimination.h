@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class DeadCodeElimination: removes the instructions whose result is
+// never read, using the liveness of the names of the subroutine.
+// Only the instructions without side effects (see InstructionInfo)
+// are removed: CALL, PUSH, XLOAD, READ*, WRITE* and DIV (that may
+// trap) always stay, and a POP whose value is dead just discards it.
+
+class DeadCodeElimination {
+
+public:
+
+  // Constructor
+  DeadCodeElimination(CodeStats & Stats);
+
+  // Runs the pass on subr. Returns true if the code changed
+  bool run(subroutine & subr);
+
+private:
+
+  // Attributes
+  CodeStats & Stats;
+
+};  // class DeadCodeElimination
@@ -0,0 +1,96 @@
+#include "DeadStoreElimination.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ControlFlowGraph.h"
+#include "InstructionInfo.h"
+
+#include <utility>
+#include <vector>
+
+// using namespace std;
+
+
+// Constructor
+DeadStoreElimination::DeadStoreElimination(CodeStats & Stats) :
+  Stats{Stats} {
+}
+
+bool DeadStoreElimination::run(subroutine & subr) {
+  ControlFlowGraph cfg(subr.instructions);
+  int n = cfg.blocks.size();
+
+  params.clear();
+  escaped.clear();
+  for (auto & param : subr.params)
+    params.insert(param.name);
+  for (auto & block : cfg.blocks)
+    for (auto & instr : block.instructions)
+      if (instr.oper == "ALOAD") escaped.insert(instr.arg2);
+
+  // Arrays live at the exit of each block: read by a LOADX on some
+  // path before a RETURN
+  std::vector<std::set<std::string>> liveIn(n), liveOut(n);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int b = n-1; b >= 0; --b) {
+      std::set<std::string> live;
+      for (int s : cfg.blocks[b].succs)
+        live.insert(liveIn[s].begin(), liveIn[s].end());
+      liveOut[b] = live;
+      for (auto & instr : cfg.blocks[b].instructions)
+        if (instr.oper == "LOADX" and isLocalArray(instr.arg2)) live.insert(instr.arg2);
+      if (live != liveIn[b]) {
+        liveIn[b] = live;
+        changed = true;
+      }
+    }
+  }
+
+  int unread = 0, overwritten = 0;
+  for (int b = 0; b < n; ++b) {
+    std::set<std::string>                          live = liveOut[b];
+    std::vector<std::pair<std::string,std::string>> stored;   // (array, offset) stored later
+    instructionList & instrs = cfg.blocks[b].instructions;
+    for (auto it = instrs.end(); it != instrs.begin(); ) {
+      --it;
+      if (it->oper == "XLOAD" and isLocalArray(it->arg1)) {
+        std::pair<std::string,std::string> element = {it->arg1, it->arg2};
+        bool isStored = false;
+        for (auto & e : stored) isStored = isStored or e == element;
+        if (not live.count(it->arg1) or isStored) {
+          ++(isStored ? overwritten : unread);
+          it = instrs.erase(it);
+          continue;
+        }
+        stored.push_back(element);
+        continue;
+      }
+      if (it->oper == "LOADX" and isLocalArray(it->arg2)) {
+        live.insert(it->arg2);
+        for (auto e = stored.begin(); e != stored.end(); ) {
+          if (e->first == it->arg2) e = stored.erase(e);
+          else ++e;
+        }
+      }
+      // the stores after a write of their offset are other elements
+      std::string def = InstructionInfo::getDef(*it);
+      for (auto e = stored.begin(); e != stored.end(); ) {
+        if (not def.empty() and e->second == def) e = stored.erase(e);
+        else ++e;
+      }
+    }
+  }
+
+  Stats.addCounter(subr.name, "dse.unread", unread);
+  Stats.addCounter(subr.name, "dse.overwritten", overwritten);
+  if (unread + overwritten == 0) return false;
+  subr.set_instructions(cfg.lower());
+  return true;
+}
+
+bool DeadStoreElimination::isLocalArray(const std::string & base) const {
+  return not InstructionInfo::isTemp(base) and not params.count(base) and
+         not escaped.count(base);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+
+#include <set>
+#include <string>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class DeadStoreElimination: removes the stores (XLOAD) into local
+// arrays that can not be read. The arrays read later are found with a
+// backward liveness over the graph, one fact per array: a LOADX makes
+// the whole array live, and nothing is live after a RETURN. A store is
+// dead if its array is not live after it (never read again before
+// returning), or if the same element (same array and offset name,
+// with the offset not written in between) is stored again later in
+// the block before any read of the array. Only local arrays whose
+// address is never taken (ALOAD) are considered: the arrays of the
+// caller, reached through the parameters, and the ones passed to a
+// call may be read outside. The dead stores into scalar variables are
+// removed by the DeadCodeElimination.
+
+class DeadStoreElimination {
+
+public:
+
+  // Constructor
+  DeadStoreElimination(CodeStats & Stats);
+
+  // Runs the pass on subr. Returns true if the code changed
+  bool run(subroutine & subr);
+
+private:
+
+  // Attributes
+  CodeStats & Stats;
+
+  // True if base is a local array only accessed directly
+  bool isLocalArray(const std::string & base) const;
+
+  // Parameters and local arrays whose address is taken
+  std::set<std::string> params;
+  std::set<std::string> escaped;
+
+};  // class DeadStoreElimination
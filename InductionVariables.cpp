@@ -0,0 +1,165 @@
+#include "InductionVariables.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ControlFlowGraph.h"
+#include "InstructionInfo.h"
+#include "Liveness.h"
+
+#include <algorithm>
+#include <cstdlib>    // atoi
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+// using namespace std;
+
+
+// Constructor
+InductionVariables::InductionVariables(CodeStats & Stats) :
+  Stats{Stats} {
+}
+
+bool InductionVariables::run(subroutine & subr) {
+  reduced = removed = 0;
+  lastTemp = 0;
+  for (auto & instr : subr.instructions)
+    for (auto & arg : {instr.arg1, instr.arg2, instr.arg3})
+      if (InstructionInfo::isTemp(arg))
+        lastTemp = std::max(lastTemp, std::atoi(arg.c_str() + 1));
+
+  // start again after each loop that changes, from the inner ones
+  bool changed = true, any = false;
+  while (changed) {
+    changed = false;
+    ControlFlowGraph cfg(subr.instructions);
+    cfg.computeLoops();
+    for (int l = int(cfg.loops.size()) - 1; l >= 0 and not changed; --l)
+      changed = reduce(subr, l);
+    any = any or changed;
+  }
+
+  Stats.addCounter(subr.name, "iv.reduced", reduced);
+  Stats.addCounter(subr.name, "iv.removed", removed);
+  return any;
+}
+
+bool InductionVariables::reduce(subroutine & subr, int l) {
+  ControlFlowGraph cfg(subr.instructions);
+  cfg.computeLoops();
+  if (not cfg.canInsertPreheader(l)) return false;
+  const ControlFlowGraph::Loop & loop = cfg.loops[l];
+  std::set<int> inLoop(loop.blocks.begin(), loop.blocks.end());
+
+  // writes of each name in the loop
+  std::map<std::string, int> writes;
+  for (int b : loop.blocks)
+    for (auto & instr : cfg.blocks[b].instructions) {
+      std::string def = InstructionInfo::getDef(instr);
+      if (not def.empty()) ++writes[def];
+    }
+  auto invariant = [&](const std::string & name) {
+    return InstructionInfo::isName(name) and writes[name] == 0;
+  };
+
+  // The basic induction variables, with their increments
+  std::map<std::string, instruction *> increment;
+  for (int b : loop.blocks)
+    for (auto & instr : cfg.blocks[b].instructions) {
+      const std::string & i = instr.arg1;
+      if ((instr.oper != "ADD" and instr.oper != "SUB") or writes[i] != 1) continue;
+      if (instr.arg2 == i and invariant(instr.arg3))
+        increment[i] = &instr;
+      else if (instr.oper == "ADD" and instr.arg3 == i and invariant(instr.arg2)) {
+        std::swap(instr.arg2, instr.arg3);
+        increment[i] = &instr;
+      }
+    }
+  if (increment.empty()) return false;
+
+  // The multiplications by them (ADD t i i is i*2): one reduced
+  // temporal for each (i, k)
+  instructionList                                         preheader;
+  std::map<std::pair<std::string,std::string>, std::string> reducedOf;
+  std::map<std::string, std::string>                        twoOf;   // i -> k holding 2
+  for (int b : loop.blocks)
+    for (auto & instr : cfg.blocks[b].instructions) {
+      if (writes[instr.arg1] != 1 or increment.count(instr.arg1)) continue;
+      std::string i = instr.arg2, k = instr.arg3;
+      bool        doubled = instr.oper == "ADD" and i == k and increment.count(i);
+      if (doubled) {
+        if (not twoOf.count(i)) {
+          twoOf[i] = newTemp();
+          preheader.push_back(instruction::ILOAD(twoOf[i], "2"));
+        }
+        k = twoOf[i];
+      }
+      else {
+        if (instr.oper != "MUL") continue;
+        if (not increment.count(i)) std::swap(i, k);
+        if (not increment.count(i) or not invariant(k)) continue;
+      }
+
+      auto key = std::make_pair(i, k);
+      if (not reducedOf.count(key)) {
+        std::string s = newTemp(), step = newTemp();
+        instruction & inc = *increment[i];
+        preheader.push_back(instruction::MUL(s, i, k));
+        preheader.push_back(instruction::MUL(step, inc.arg3, k));
+        for (int x : loop.blocks) {
+          instructionList & instrs = cfg.blocks[x].instructions;
+          for (auto it = instrs.begin(); it != instrs.end(); ++it)
+            if (&*it == &inc) {
+              instruction update = (inc.oper == "ADD") ? instruction::ADD(s, s, step)
+                                                       : instruction::SUB(s, s, step);
+              instrs.insert(std::next(it), update);
+              break;
+            }
+        }
+        reducedOf[key] = s;
+      }
+      instr = instruction::LOAD(instr.arg1, reducedOf[key]);
+      ++reduced;
+    }
+  if (reducedOf.empty()) return false;
+
+  // The induction variables only left to increment themselves. The
+  // comparisons of i stay on i: s wraps around when i*k overflows,
+  // and i < n is not s < n*k then
+  Liveness          liveness(cfg);
+  Liveness::NameSet liveAfter;
+  for (int b : loop.blocks)
+    for (int s : cfg.blocks[b].succs)
+      if (not inLoop.count(s))
+        liveAfter.insert(liveness.liveIn[s].begin(), liveness.liveIn[s].end());
+  for (auto & entry : increment) {
+    const std::string & i = entry.first;
+    int reads = 0;
+    for (int b : loop.blocks)
+      for (auto & instr : cfg.blocks[b].instructions)
+        for (auto & name : InstructionInfo::getUses(instr))
+          reads += (name == i);
+    if (reads != 1 or liveAfter.count(i)) continue;
+    for (int b : loop.blocks) {
+      instructionList & instrs = cfg.blocks[b].instructions;
+      for (auto it = instrs.begin(); it != instrs.end(); ++it)
+        if (&*it == entry.second) {
+          instrs.erase(it);
+          ++removed;
+          break;
+        }
+    }
+  }
+
+  // the preheader, before the header
+  ControlFlowGraph::BasicBlock block;
+  block.instructions = preheader;
+  cfg.blocks.insert(cfg.blocks.begin() + loop.header, block);
+  subr.set_instructions(cfg.lower());
+  return true;
+}
+
+std::string InductionVariables::newTemp() {
+  return "%" + std::to_string(++lastTemp);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+
+#include <string>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class InductionVariables: strength reduction of the multiplications
+// by an induction variable in the loops. A basic induction variable i
+// is written once in the loop, by ADD i i c (or SUB i i c) with c not
+// written in the loop. A multiplication MUL t i k, with k not written
+// in the loop either, is replaced by a copy of a new temporal s that
+// always holds i*k: s = i*k is computed in a preheader, and s = s+c*k
+// right after the increment of i (ADD t i i is taken as MUL t i 2).
+// A basic induction variable then only read by its own increment,
+// and not read after the loop, is removed (its increment is). The
+// comparisons of i are not moved to s: i*k may overflow where i does
+// not, and the VM ints wrap around.
+// Inner loops are done first.
+
+class InductionVariables {
+
+public:
+
+  // Constructor
+  InductionVariables(CodeStats & Stats);
+
+  // Runs the pass on subr. Returns true if the code changed
+  bool run(subroutine & subr);
+
+private:
+
+  // Attributes
+  CodeStats & Stats;
+
+  // Reduces the multiplications of one loop of subr (the loop index
+  // in the ControlFlowGraph::loops). Returns true if the code changed
+  bool reduce(subroutine & subr, int l);
+
+  // A temporal not used yet
+  std::string newTemp();
+
+  // Highest temporal number used in the subroutine, and counters
+  int lastTemp;
+  int reduced, removed;
+
+};  // class InductionVariables
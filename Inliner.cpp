@@ -0,0 +1,188 @@
+#include "Inliner.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "InstructionInfo.h"
+
+#include <algorithm>
+#include <cstdlib>    // atoi
+#include <iterator>
+#include <set>
+#include <vector>
+
+// using namespace std;
+
+
+// Constructor
+Inliner::Inliner(code & Code, CodeStats & Stats, int sizeLimit, int growthLimit) :
+  Code{Code},
+  Stats{Stats},
+  sizeLimit{sizeLimit},
+  growthLimit{growthLimit},
+  copies{0} {
+}
+
+bool Inliner::run(subroutine & subr) {
+  instructionList & instrs = subr.instructions;
+  int lastTemp = 0;
+  for (auto & instr : instrs)
+    for (auto & arg : {instr.arg1, instr.arg2, instr.arg3})
+      if (InstructionInfo::isTemp(arg))
+        lastTemp = std::max(lastTemp, std::atoi(arg.c_str() + 1));
+
+  int inlined = 0, growth = 0;
+  for (auto it = instrs.begin(); it != instrs.end(); ++it) {
+    if (it->oper != "CALL" or it->arg1 == subr.name) continue;
+    const subroutine * callee = findSubroutine(it->arg1);
+    if (not callee or not isInlinable(*callee)) continue;
+
+    // the call sequence: a PUSH per parameter before, a POP after
+    int nParams = callee->params.size();
+    auto first = it, last = std::next(it);
+    bool matches = true;
+    for (int k = 0; k < nParams and matches; ++k) {
+      matches = first != instrs.begin() and std::prev(first)->oper == "PUSH";
+      if (matches) --first;
+    }
+    for (int k = 0; k < nParams and matches; ++k) {
+      matches = last != instrs.end() and last->oper == "POP";
+      if (matches) ++last;
+    }
+    if (not matches) continue;
+    // a procedure is called with a result slot too
+    bool isFunction = nParams > 0 and callee->params.front().name == "_result";
+    if (not isFunction and first != instrs.begin() and std::prev(first)->oper == "PUSH" and
+        std::prev(first)->arg1.empty() and last != instrs.end() and last->oper == "POP" and
+        last->arg1.empty()) {
+      --first;
+      ++last;
+    }
+
+    int size = 0;
+    for (auto & instr : callee->instructions)
+      size += not InstructionInfo::isLabel(instr);
+    int cost = size - (2*nParams + 1);
+    if (size > sizeLimit or growth + cost > growthLimit) continue;
+
+    // the parameters: a new temporal with the value pushed
+    instructionList                    code;
+    std::map<std::string, std::string> params;
+    auto push = std::prev(it, nParams);
+    for (auto & param : callee->params) {
+      std::string temp = "%" + std::to_string(++lastTemp);
+      params[param.name] = temp;
+      if (not push->arg1.empty()) code.push_back(instruction::LOAD(temp, push->arg1));
+      ++push;
+    }
+    std::string endLabel = "endinline" + std::to_string(++copies);
+    instructionList body = copyBody(subr, *callee, params, endLabel, lastTemp);
+    code.insert(code.end(), body.begin(), body.end());
+    code.push_back(instruction::LABEL(endLabel));
+    // the value of _result, into the temporal of the last POP
+    const instruction & result = *std::prev(last);
+    if (isFunction and not result.arg1.empty())
+      code.push_back(instruction::LOAD(result.arg1, params["_result"]));
+
+    it = instrs.erase(first, last);
+    it = instrs.insert(it, code.begin(), code.end());
+    std::advance(it, code.size() - 1);
+    growth += cost;
+    ++inlined;
+  }
+
+  Stats.addCounter(subr.name, "inline.calls", inlined);
+  Stats.addCounter(subr.name, "inline.growth", growth);
+  return inlined > 0;
+}
+
+const subroutine * Inliner::findSubroutine(const std::string & name) const {
+  for (auto & subr : Code.subroutines)
+    if (subr.name == name) return &subr;
+  return nullptr;
+}
+
+bool Inliner::isInlinable(const subroutine & callee) const {
+  if (callee.name == "main") return false;
+  for (auto & instr : callee.instructions)
+    if (instr.oper == "HALT") return false;
+
+  // recursive, directly or through other subroutines: callee is on a
+  // cycle of the call graph
+  std::set<std::string>           visited;
+  std::vector<const subroutine *> pending = {&callee};
+  while (not pending.empty()) {
+    const subroutine * subr = pending.back();
+    pending.pop_back();
+    for (auto & instr : subr->instructions) {
+      if (instr.oper != "CALL") continue;
+      if (instr.arg1 == callee.name) return false;
+      const subroutine * next = findSubroutine(instr.arg1);
+      if (next and visited.insert(instr.arg1).second) pending.push_back(next);
+    }
+  }
+  return true;
+}
+
+instructionList Inliner::copyBody(subroutine & subr, const subroutine & callee,
+                                  const std::map<std::string, std::string> & params,
+                                  const std::string & endLabel, int & lastTemp) {
+  std::string suffix = "_inline" + std::to_string(copies);
+
+  // the arrays of the callee: the names used as base addresses
+  std::set<std::string> arrays;
+  for (auto & instr : callee.instructions)
+    for (std::string * arg : InstructionInfo::getUseArgs(const_cast<instruction &>(instr)))
+      if (InstructionInfo::isAddressArg(instr, arg) and not InstructionInfo::isTemp(*arg))
+        arrays.insert(*arg);
+
+  // new names: the local arrays become arrays of subr (name_inlineN,
+  // with more '_' at the end while subr has that name already: it is
+  // an ASL identifier too), and the rest of the names (temporals,
+  // scalar variables) new temporals
+  std::set<std::string> taken;
+  for (auto & var : subr.params) taken.insert(var.name);
+  for (auto & var : subr.vars)   taken.insert(var.name);
+  std::map<std::string, std::string> names = params;
+  for (auto & var : callee.vars) {
+    if (arrays.count(var.name)) {
+      std::string name = var.name + suffix;
+      while (taken.count(name)) name += "_";
+      taken.insert(name);
+      names[var.name] = name;
+      subr.add_var(name, var.nelem);
+    }
+    else names[var.name] = "%" + std::to_string(++lastTemp);
+  }
+  auto rename = [&](std::string & name) {
+    if (name.empty()) return;
+    auto it = names.find(name);
+    if (it != names.end()) name = it->second;
+    else if (InstructionInfo::isTemp(name))
+      name = names[name] = "%" + std::to_string(++lastTemp);
+  };
+
+  instructionList code;
+  for (instruction instr : callee.instructions) {
+    const std::string & op = instr.oper;
+    if (op == "RETURN")
+      instr = instruction::UJUMP(endLabel);
+    else if (InstructionInfo::isLabel(instr) or InstructionInfo::isJump(instr)) {
+      InstructionInfo::setLabel(instr, InstructionInfo::getLabel(instr) + suffix);
+      if (op == "FJUMP") rename(instr.arg1);
+    }
+    else if (op == "ALOAD" and params.count(instr.arg2)) {
+      // an array parameter passed on: the address it holds
+      instr = instruction::LOAD(instr.arg1, params.at(instr.arg2));
+      rename(instr.arg1);
+    }
+    else if (op == "ILOAD" or op == "FLOAD" or op == "CHLOAD")
+      rename(instr.arg1);
+    else if (op != "CALL" and op != "WRITES") {
+      rename(instr.arg1);
+      rename(instr.arg2);
+      rename(instr.arg3);
+    }
+    code.push_back(instr);
+  }
+  return code;
+}
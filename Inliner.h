@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+
+#include <map>
+#include <string>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class Inliner: replaces the calls to small subroutines by a copy of
+// their code. A call sequence (PUSH of the result slot, also pushed
+// for a procedure, and of each argument, CALL, a POP per argument and
+// the POP of the result) becomes:
+//   - a copy of each argument into a new temporal, the parameter (an
+//     array argument is its address, from the ALOAD of the caller,
+//     and an int passed to a float parameter was already converted)
+//   - the code of the callee, with its temporals and scalar variables
+//     renamed to new temporals, its local arrays added to the caller
+//     with a new name, and its labels renamed. An ALOAD of a parameter
+//     (an array passed on) copies the address it holds, and a RETURN
+//     jumps to the end of the copy
+//   - a copy of the temporal of _result into the one of the last POP
+// The cost of a call is the size of the callee (instructions other
+// than LABELs) minus the call sequence it saves: a callee is only
+// copied if its size is at most sizeLimit, and while the caller has
+// not grown more than growthLimit instructions. Recursive callees
+// (on a cycle of the call graph, so the callees-first order can not
+// have optimized them before their callers) and main are never
+// copied, nor the calls in the code copied.
+
+class Inliner {
+
+public:
+
+  // Constructor
+  Inliner(code & Code, CodeStats & Stats, int sizeLimit, int growthLimit);
+
+  // Inlines the calls of subr. Returns true if the code changed
+  bool run(subroutine & subr);
+
+private:
+
+  // Attributes
+  code      & Code;
+  CodeStats & Stats;
+  int         sizeLimit;
+  int         growthLimit;
+
+  // The subroutine called name, or nullptr if it is not in the code
+  const subroutine * findSubroutine(const std::string & name) const;
+
+  // True if callee can be copied into other subroutines: not main,
+  // and not reaching a call to itself
+  bool isInlinable(const subroutine & callee) const;
+
+  // The code of callee, renamed to be copied into subr: params maps
+  // each parameter to the temporal holding its value, and the
+  // temporals from lastTemp on are free
+  instructionList copyBody(subroutine & subr, const subroutine & callee,
+                           const std::map<std::string, std::string> & params,
+                           const std::string & endLabel, int & lastTemp);
+
+  // Number of calls inlined so far, to name the copies
+  int copies;
+
+};  // class Inliner
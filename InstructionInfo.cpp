@@ -0,0 +1,119 @@
+#include "InstructionInfo.h"
+
+#include "../common/code.h"
+
+#include <cctype>     // isdigit
+#include <set>
+
+// using namespace std;
+
+
+// Opcodes by the roles of their args
+//   dst src1 src2
+static const std::set<std::string> binaryOps = {
+  "ADD", "SUB", "MUL", "DIV", "FADD", "FSUB", "FMUL", "FDIV",
+  "EQ", "LT", "LE", "FEQ", "FLT", "FLE", "AND", "OR" };
+//   dst src
+static const std::set<std::string> unaryOps = {
+  "NEG", "FNEG", "NOT", "FLOAT", "LOAD", "ALOAD" };
+//   dst literal
+static const std::set<std::string> literalOps = {
+  "ILOAD", "FLOAD", "CHLOAD" };
+//   dst  (reads from the input)
+static const std::set<std::string> readOps = {
+  "READI", "READF", "READC" };
+//   src  (writes to the output)
+static const std::set<std::string> writeOps = {
+  "WRITEI", "WRITEF", "WRITEC" };
+
+
+std::string InstructionInfo::getDef(const instruction & instr) {
+  const std::string & op = instr.oper;
+  if (binaryOps.count(op) or unaryOps.count(op) or literalOps.count(op) or
+      readOps.count(op) or op == "LOADX" or op == "POP")
+    return instr.arg1;   // "" for a POP that discards the value
+  return "";
+}
+
+std::vector<std::string> InstructionInfo::getUses(const instruction & instr) {
+  std::vector<std::string> uses;
+  for (std::string * arg : getUseArgs(const_cast<instruction &>(instr)))
+    uses.push_back(*arg);
+  return uses;
+}
+
+std::vector<std::string *> InstructionInfo::getUseArgs(instruction & instr) {
+  std::vector<std::string *> args;
+  const std::string & op = instr.oper;
+  if (binaryOps.count(op) or op == "LOADX")
+    args = {&instr.arg2, &instr.arg3};
+  else if (unaryOps.count(op))
+    args = {&instr.arg2};
+  else if (op == "XLOAD")
+    args = {&instr.arg1, &instr.arg2, &instr.arg3};
+  else if (writeOps.count(op) or op == "PUSH")
+    args = {&instr.arg1};
+  else if (op == "FJUMP")
+    args = {&instr.arg1};
+
+  // literals (LOAD t 1) and empty args (PUSH) are not names
+  std::vector<std::string *> names;
+  for (std::string * arg : args)
+    if (isName(*arg)) names.push_back(arg);
+  return names;
+}
+
+bool InstructionInfo::isAddressArg(const instruction & instr, const std::string * arg) {
+  return (instr.oper == "LOADX" and arg == &instr.arg2) or
+         (instr.oper == "XLOAD" and arg == &instr.arg1) or
+         (instr.oper == "ALOAD" and arg == &instr.arg2);
+}
+
+bool InstructionInfo::hasSideEffects(const instruction & instr) {
+  const std::string & op = instr.oper;
+  if (op == "DIV") return true;   // traps on a division by zero
+  return not (binaryOps.count(op) or unaryOps.count(op) or literalOps.count(op) or
+              op == "LOADX" or op == "NOOP");
+}
+
+bool InstructionInfo::isPure(const instruction & instr) {
+  const std::string & op = instr.oper;
+  return binaryOps.count(op) or unaryOps.count(op) or literalOps.count(op);
+}
+
+bool InstructionInfo::isLabel(const instruction & instr) {
+  return instr.oper == "LABEL";
+}
+
+bool InstructionInfo::isJump(const instruction & instr) {
+  return instr.oper == "UJUMP" or instr.oper == "FJUMP";
+}
+
+bool InstructionInfo::isReturn(const instruction & instr) {
+  return instr.oper == "RETURN" or instr.oper == "HALT";
+}
+
+bool InstructionInfo::endsBlock(const instruction & instr) {
+  return isJump(instr) or isReturn(instr);
+}
+
+bool InstructionInfo::fallsThrough(const instruction & instr) {
+  return not (instr.oper == "UJUMP" or isReturn(instr));
+}
+
+std::string InstructionInfo::getLabel(const instruction & instr) {
+  return instr.oper == "FJUMP" ? instr.arg2 : instr.arg1;
+}
+
+void InstructionInfo::setLabel(instruction & instr, const std::string & label) {
+  if (instr.oper == "FJUMP") instr.arg2 = label;
+  else                       instr.arg1 = label;
+}
+
+bool InstructionInfo::isName(const std::string & arg) {
+  return not arg.empty() and not std::isdigit(arg[0]) and arg[0] != '-';
+}
+
+bool InstructionInfo::isTemp(const std::string & arg) {
+  return not arg.empty() and arg[0] == '%';
+}
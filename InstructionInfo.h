@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../common/code.h"
+
+#include <string>
+#include <vector>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class InstructionInfo: what the optimization passes need to know
+// about each t-code instruction: the name it defines, the names it
+// uses and whether it has effects besides defining its result.
+// Names are the variables, parameters and temporals (%N) of the
+// subroutine; literals (ILOAD 3, LOAD t 1) and labels are not names.
+// Arrays live in memory: they are only accessed with LOADX, XLOAD and
+// ALOAD, and a CALL may write the ones passed by reference. Scalars
+// are passed by value, so a CALL never changes a scalar name.
+
+class InstructionInfo {
+
+public:
+
+  // Name written by instr, or "" if it does not define any
+  static std::string getDef(const instruction & instr);
+
+  // Names read by instr (RETURN reads no name, but see isReturn)
+  static std::vector<std::string> getUses(const instruction & instr);
+
+  // The args of instr holding the names it reads, so they can be renamed
+  static std::vector<std::string *> getUseArgs(instruction & instr);
+
+  // True if arg (one of the args of instr) names an array in memory
+  // or holds its address: the base of LOADX/XLOAD and the array of
+  // ALOAD. Only a temporal holding the same address can replace it
+  static bool isAddressArg(const instruction & instr, const std::string * arg);
+
+  // True if instr can not be removed even when its result is not
+  // used: I/O, stores into memory, calls and the stack, control flow
+  // and instructions that may trap (DIV)
+  static bool hasSideEffects(const instruction & instr);
+
+  // True if instr is a pure operation of its operands (no memory
+  // read, no I/O) whose result only depends on their values
+  static bool isPure(const instruction & instr);
+
+  // Control flow
+  static bool isLabel     (const instruction & instr);
+  static bool isJump      (const instruction & instr);   // UJUMP or FJUMP
+  static bool isReturn    (const instruction & instr);   // RETURN or HALT
+  static bool endsBlock   (const instruction & instr);   // jump, RETURN or HALT
+  static bool fallsThrough(const instruction & instr);   // not UJUMP, RETURN nor HALT
+  static std::string getLabel(const instruction & instr);  // of LABEL/UJUMP/FJUMP
+  static void        setLabel(instruction & instr, const std::string & label);
+
+  // Kinds of args
+  static bool isName (const std::string & arg);   // variable or temporal
+  static bool isTemp (const std::string & arg);   // %N temporal
+
+};  // class InstructionInfo
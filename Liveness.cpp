@@ -0,0 +1,40 @@
+#include "Liveness.h"
+
+#include "../common/code.h"
+#include "ControlFlowGraph.h"
+#include "InstructionInfo.h"
+
+// using namespace std;
+
+
+// Constructor
+Liveness::Liveness(const ControlFlowGraph & cfg) :
+  liveIn(cfg.blocks.size()),
+  liveOut(cfg.blocks.size()) {
+  // backwards, until nothing changes
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int b = int(cfg.blocks.size()) - 1; b >= 0; --b) {
+      NameSet live;
+      for (int s : cfg.blocks[b].succs)
+        live.insert(liveIn[s].begin(), liveIn[s].end());
+      liveOut[b] = live;
+      const instructionList & instrs = cfg.blocks[b].instructions;
+      for (auto it = instrs.rbegin(); it != instrs.rend(); ++it)
+        transfer(*it, live);
+      if (live != liveIn[b]) {
+        liveIn[b] = live;
+        changed   = true;
+      }
+    }
+  }
+}
+
+void Liveness::transfer(const instruction & instr, NameSet & live) {
+  std::string def = InstructionInfo::getDef(instr);
+  if (not def.empty()) live.erase(def);
+  for (auto & name : InstructionInfo::getUses(instr))
+    live.insert(name);
+  if (instr.oper == "RETURN") live.insert("_result");
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "../common/code.h"
+#include "ControlFlowGraph.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class Liveness: the names live at the entry and at the exit of each
+// basic block of a control flow graph (a name is live if its value
+// may be read before being written again). _result is read by the
+// caller, so it is live at every RETURN.
+
+class Liveness {
+
+public:
+
+  typedef std::set<std::string> NameSet;
+
+  // Constructor: computes the live names of the blocks of cfg
+  Liveness(const ControlFlowGraph & cfg);
+
+  // Live names at the entry/exit of each block
+  std::vector<NameSet> liveIn;
+  std::vector<NameSet> liveOut;
+
+  // From the names live after instr to the ones live before it
+  static void transfer(const instruction & instr, NameSet & live);
+
+};  // class Liveness
@@ -0,0 +1,125 @@
+#include "LoopInvariantCodeMotion.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ControlFlowGraph.h"
+#include "InstructionInfo.h"
+#include "Liveness.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// using namespace std;
+
+
+// Constructor
+LoopInvariantCodeMotion::LoopInvariantCodeMotion(CodeStats & Stats) :
+  Stats{Stats} {
+}
+
+bool LoopInvariantCodeMotion::run(subroutine & subr) {
+  int hoisted = 0;
+
+  // moving code changes the blocks: start again after each loop that
+  // changes, from the inner ones
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    ControlFlowGraph cfg(subr.instructions);
+    cfg.computeLoops();
+    for (int l = int(cfg.loops.size()) - 1; l >= 0 and not changed; --l) {
+      int n = hoist(subr, l);
+      hoisted += n;
+      changed  = n > 0;
+    }
+  }
+
+  Stats.addCounter(subr.name, "licm.hoisted", hoisted);
+  return hoisted > 0;
+}
+
+int LoopInvariantCodeMotion::hoist(subroutine & subr, int l) {
+  ControlFlowGraph cfg(subr.instructions);
+  cfg.computeLoops();
+  const ControlFlowGraph::Loop & loop = cfg.loops[l];
+  int header = loop.header;
+
+  if (not cfg.canInsertPreheader(l)) return 0;
+  std::set<int> inLoop(loop.blocks.begin(), loop.blocks.end());
+
+  // writes of each name in the loop, and the only write of a literal
+  // into a name in the whole subroutine (for the divisors)
+  std::map<std::string, int> writes, writesInSubr;
+  std::map<std::string, std::string> literalOf;
+  for (int b = 0; b < int(cfg.blocks.size()); ++b)
+    for (auto & instr : cfg.blocks[b].instructions) {
+      std::string def = InstructionInfo::getDef(instr);
+      if (def.empty()) continue;
+      if (inLoop.count(b)) ++writes[def];
+      ++writesInSubr[def];
+      if ((instr.oper == "ILOAD" or instr.oper == "LOAD") and
+          not InstructionInfo::isName(instr.arg2))
+        literalOf[def] = instr.arg2;
+    }
+  auto nonzeroLiteral = [&](const std::string & name) {
+    return writesInSubr[name] == 1 and literalOf.count(name) and
+           literalOf[name].find_first_not_of("0.") != std::string::npos;
+  };
+
+  // the blocks leaving the loop, and the names read after it
+  Liveness          liveness(cfg);
+  std::vector<int>  exiting;
+  Liveness::NameSet liveAfter;
+  for (int b : loop.blocks)
+    for (int s : cfg.blocks[b].succs)
+      if (not inLoop.count(s)) {
+        exiting.push_back(b);
+        liveAfter.insert(liveness.liveIn[s].begin(), liveness.liveIn[s].end());
+      }
+
+  // invariant instructions, until no more are found
+  std::set<std::string>    invariant;   // names written by moved instructions
+  std::vector<instruction> moved;
+  bool found = true;
+  while (found) {
+    found = false;
+    for (int b : loop.blocks) {
+      bool runsAlways = true;
+      for (int e : exiting) runsAlways = runsAlways and cfg.dominates(b, e);
+      for (auto & instr : cfg.blocks[b].instructions) {
+        std::string def = InstructionInfo::getDef(instr);
+        if (def.empty() or invariant.count(def) or writes[def] != 1 or
+            not InstructionInfo::isPure(instr) or liveness.liveIn[header].count(def) or
+            (liveAfter.count(def) and not runsAlways))
+          continue;
+        if (InstructionInfo::hasSideEffects(instr) and
+            not (instr.oper == "DIV" and nonzeroLiteral(instr.arg3)))
+          continue;
+        bool operandsInvariant = true;
+        for (auto & name : InstructionInfo::getUses(instr))
+          operandsInvariant = operandsInvariant and (writes[name] == 0 or invariant.count(name));
+        if (not operandsInvariant) continue;
+        invariant.insert(def);
+        moved.push_back(instr);
+        found = true;
+      }
+    }
+  }
+  if (moved.empty()) return 0;
+
+  // out of the loop, into a new block before the header
+  for (int b : loop.blocks) {
+    instructionList & instrs = cfg.blocks[b].instructions;
+    for (auto it = instrs.begin(); it != instrs.end(); ) {
+      if (invariant.count(InstructionInfo::getDef(*it))) it = instrs.erase(it);
+      else ++it;
+    }
+  }
+  ControlFlowGraph::BasicBlock preheader;
+  preheader.instructions.insert(preheader.instructions.end(), moved.begin(), moved.end());
+  cfg.blocks.insert(cfg.blocks.begin() + header, preheader);
+  subr.set_instructions(cfg.lower());
+  return moved.size();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class LoopInvariantCodeMotion: moves the instructions of a loop
+// that compute the same value in every iteration into a preheader, a
+// block just before the loop header that runs once. An instruction is
+// moved if:
+//   - it is pure (ILOAD, LOAD of a base address, FLOAT, arithmetic...)
+//     and its operands are not written in the loop, or are written by
+//     instructions moved too
+//   - it is the only write of its result in the loop, and the result
+//     is not read in the loop before it (not live at the header)
+//   - the result is not read after the loop, unless the instruction
+//     runs in every iteration (its block dominates the loop exits)
+// A DIV may trap, so it only moves when its divisor is a nonzero
+// literal. Inner loops are done first.
+
+class LoopInvariantCodeMotion {
+
+public:
+
+  // Constructor
+  LoopInvariantCodeMotion(CodeStats & Stats);
+
+  // Runs the pass on subr. Returns true if the code changed
+  bool run(subroutine & subr);
+
+private:
+
+  // Attributes
+  CodeStats & Stats;
+
+  // Moves the invariant instructions of one loop of subr (the loop
+  // index in the ControlFlowGraph::loops). Returns the instructions moved
+  int hoist(subroutine & subr, int l);
+
+};  // class LoopInvariantCodeMotion
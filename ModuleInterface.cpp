@@ -0,0 +1,146 @@
+#include "ModuleInterface.h"
+
+#include "../common/TypesMgr.h"
+
+#include <cctype>     // isalnum, isdigit, isspace
+#include <fstream>
+#include <sstream>
+
+// using namespace std;
+
+
+// Constructor
+ModuleInterface::ModuleInterface(TypesMgr & Types) :
+  Types{Types} {
+}
+
+void ModuleInterface::addFunction(const std::string & name, TypesMgr::TypeId tFunc) {
+  functions.push_back({name, tFunc});
+}
+
+const std::vector<std::pair<std::string, TypesMgr::TypeId>> & ModuleInterface::getFunctions() const {
+  return functions;
+}
+
+bool ModuleInterface::read(const std::string & fileName) {
+  std::ifstream stream(fileName);
+  if (not stream) return false;
+
+  std::string line;
+  while (std::getline(stream, line)) {
+    std::size_t first = line.find_first_not_of(" \t\r");
+    // skip blank and comment lines
+    if (first == std::string::npos or line.compare(first, 2, "//") == 0) continue;
+    if (not parseSignature(line)) return false;
+  }
+  return true;
+}
+
+bool ModuleInterface::write(const std::string & fileName) const {
+  std::string contents = "// ASL interface file: exported function signatures\n";
+  for (auto & f : functions)
+    contents += signatureToString(f.first, f.second) + "\n";
+
+  // keep the old file (and its timestamp) if nothing changed
+  std::ifstream old(fileName);
+  if (old) {
+    std::stringstream oldContents;
+    oldContents << old.rdbuf();
+    if (oldContents.str() == contents) return true;
+  }
+
+  std::ofstream stream(fileName);
+  stream << contents;
+  return bool(stream);
+}
+
+std::string ModuleInterface::signatureToString(const std::string & name, TypesMgr::TypeId tFunc) const {
+  std::string s = "func " + name + "(";
+  auto params = Types.getFuncParamsTypes(tFunc);
+  for (std::size_t i = 0; i < params.size(); ++i)
+    s += (i > 0 ? ", " : "") + typeToString(params[i]);
+  s += ")";
+  if (not Types.isVoidFunction(tFunc))
+    s += " : " + typeToString(Types.getFuncReturnType(tFunc));
+  return s;
+}
+
+std::string ModuleInterface::typeToString(TypesMgr::TypeId t) const {
+  if (Types.isIntegerTy(t)) return "int";
+  if (Types.isFloatTy(t))   return "float";
+  if (Types.isBooleanTy(t)) return "bool";
+  if (Types.isCharacterTy(t)) return "char";
+  /* Types.isArrayTy(t) */
+  return "array [" + std::to_string(Types.getArraySize(t)) + "] of " +
+         typeToString(Types.getArrayElemType(t));
+}
+
+bool ModuleInterface::parseSignature(const std::string & line) {
+  // split the line into words and one-char symbols: ( ) [ ] , :
+  std::vector<std::string> tokens;
+  for (std::size_t i = 0; i < line.size(); ) {
+    if (std::isspace(line[i])) ++i;
+    else if (std::isalnum(line[i]) or line[i] == '_') {
+      std::size_t j = i;
+      while (j < line.size() and (std::isalnum(line[j]) or line[j] == '_')) ++j;
+      tokens.push_back(line.substr(i, j-i));
+      i = j;
+    }
+    else tokens.push_back(line.substr(i++, 1));
+  }
+
+  std::size_t k = 0;
+  auto next = [&]() -> std::string { return k < tokens.size() ? tokens[k++] : ""; };
+
+  // basic_type
+  auto parseBasicType = [&](TypesMgr::TypeId & t) -> bool {
+    std::string tok = next();
+    if (tok == "int")        t = Types.createIntegerTy();
+    else if (tok == "float") t = Types.createFloatTy();
+    else if (tok == "bool")  t = Types.createBooleanTy();
+    else if (tok == "char")  t = Types.createCharacterTy();
+    else return false;
+    return true;
+  };
+  // basic_type | array [ INTVAL ] of basic_type
+  auto parseType = [&](TypesMgr::TypeId & t) -> bool {
+    if (k < tokens.size() and tokens[k] == "array") {
+      ++k;
+      if (next() != "[") return false;
+      std::string size = next();
+      if (size.empty() or not std::isdigit(size[0]) or next() != "]" or next() != "of")
+        return false;
+      TypesMgr::TypeId elemType;
+      if (not parseBasicType(elemType)) return false;
+      t = Types.createArrayTy(std::stoi(size), elemType);
+      return true;
+    }
+    return parseBasicType(t);
+  };
+
+  if (next() != "func") return false;
+  std::string name = next();
+  if (name.empty() or not (std::isalpha(name[0]) or name[0] == '_') or next() != "(")
+    return false;
+
+  std::vector<TypesMgr::TypeId> lParamsTy;
+  if (k < tokens.size() and tokens[k] == ")") ++k;
+  else {
+    std::string sep;
+    do {
+      TypesMgr::TypeId t;
+      if (not parseType(t)) return false;
+      lParamsTy.push_back(t);
+      sep = next();
+    } while (sep == ",");
+    if (sep != ")") return false;
+  }
+
+  TypesMgr::TypeId tRet = Types.createVoidTy();
+  if (k < tokens.size() and (next() != ":" or not parseBasicType(tRet)))
+    return false;
+  if (k != tokens.size()) return false;
+
+  functions.push_back({name, Types.createFunctionTy(lParamsTy, tRet)});
+  return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "../common/TypesMgr.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class ModuleInterface: the signatures of the functions a module
+// exports, i.e. what the SymbolsListener puts in the "$global$"
+// scope for them. An interface file has one function per line,
+// written as an ASL header without parameter names:
+//
+//     func f(int, array [10] of float) : bool
+//     func p(char)
+//
+// Interfaces are written when a module is compiled with -c and read
+// back (-i) by the modules that call its functions.
+
+class ModuleInterface {
+
+public:
+
+  // Constructor
+  ModuleInterface(TypesMgr & Types);
+
+  // Adds the function 'name' with the function type tFunc
+  void addFunction(const std::string & name, TypesMgr::TypeId tFunc);
+
+  // Functions of the interface, in the order they were added
+  const std::vector<std::pair<std::string, TypesMgr::TypeId>> & getFunctions() const;
+
+  // Reads the functions of an interface file. Returns false if the
+  // file can not be opened or has a malformed line
+  bool read(const std::string & fileName);
+
+  // Writes the interface file. The file is only rewritten if its
+  // contents change, so its timestamp tells whether the modules that
+  // import it have to be recompiled. Returns false on error
+  bool write(const std::string & fileName) const;
+
+private:
+
+  // Attributes
+  TypesMgr & Types;
+  std::vector<std::pair<std::string, TypesMgr::TypeId>> functions;
+
+  // Conversion of a function/parameter type to/from the text of the file
+  std::string      signatureToString (const std::string & name, TypesMgr::TypeId tFunc) const;
+  std::string      typeToString      (TypesMgr::TypeId t) const;
+  bool             parseSignature    (const std::string & line);
+
+};  // class ModuleInterface
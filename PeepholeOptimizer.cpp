@@ -0,0 +1,145 @@
+#include "PeepholeOptimizer.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "InstructionInfo.h"
+
+#include <iterator>
+#include <sstream>
+
+// using namespace std;
+
+
+// Constructor: the table of rules
+PeepholeOptimizer::PeepholeOptimizer(CodeStats & Stats) :
+  Stats{Stats} {
+  // a multiplication by a 1 loaded right before
+  addRule("mul_by_one",     {"LOAD $t 1", "MUL $t $x $t"}, {"LOAD $t $x"});
+  addRule("mul_by_one",     {"LOAD $t 1", "MUL $t $t $x"}, {"LOAD $t $x"});
+  // a > b, a >= b: the NOT of a comparison, with the operands swapped
+  addRule("not_le",         {"LE $t $a $b",  "NOT $t $t"}, {"LT $t $b $a"});
+  addRule("not_lt",         {"LT $t $a $b",  "NOT $t $t"}, {"LE $t $b $a"});
+  addRule("not_fle",        {"FLE $t $a $b", "NOT $t $t"}, {"FLT $t $b $a"});
+  addRule("not_flt",        {"FLT $t $a $b", "NOT $t $t"}, {"FLE $t $b $a"});
+  addRule("not_not",        {"NOT $t $a",    "NOT $t $t"}, {"LOAD $t $a"});
+  // a literal loaded into a temporal only to copy it
+  addRule("literal_copy",   {"ILOAD $t $c",  "LOAD $x $t"}, {"ILOAD $x $c"},  "$t");
+  addRule("literal_copy",   {"FLOAD $t $c",  "LOAD $x $t"}, {"FLOAD $x $c"},  "$t");
+  addRule("literal_copy",   {"CHLOAD $t $c", "LOAD $x $t"}, {"CHLOAD $x $c"}, "$t");
+  addRule("literal_copy",   {"LOAD $t 1",    "LOAD $x $t"}, {"LOAD $x 1"},    "$t");
+  addRule("literal_copy",   {"LOAD $t 0",    "LOAD $x $t"}, {"LOAD $x 0"},    "$t");
+  addRule("self_copy",      {"LOAD $x $x"},                 {});
+  // every function ends with a RETURN, even after a return statement
+  addRule("return_return",  {"RETURN", "RETURN"},           {"RETURN"});
+}
+
+void PeepholeOptimizer::addRule(const std::string & name, const std::vector<std::string> & pattern,
+                                const std::vector<std::string> & replacement,
+                                const std::string & readOnce) {
+  auto split = [](const std::string & text) {
+    std::istringstream is(text);
+    return std::vector<std::string>(std::istream_iterator<std::string>(is),
+                                    std::istream_iterator<std::string>());
+  };
+  Rule rule{name, {}, {}, readOnce};
+  for (auto & text : pattern)     rule.pattern.push_back(split(text));
+  for (auto & text : replacement) rule.replacement.push_back(split(text));
+  rules.push_back(rule);
+}
+
+bool PeepholeOptimizer::run(subroutine & subr) {
+  instructionList & instrs = subr.instructions;
+
+  // times each name is read, for the rules with readOnce
+  std::map<std::string, int> reads;
+  for (auto & instr : instrs)
+    for (auto & name : InstructionInfo::getUses(instr)) ++reads[name];
+
+  std::map<std::string, int> applied;
+  for (auto & rule : rules) applied[rule.name] = 0;
+
+  // slide the window until no rule applies
+  bool changed = true, anyChange = false;
+  while (changed) {
+    changed = false;
+    for (auto it = instrs.begin(); it != instrs.end(); ) {
+      bool rewritten = false;
+      for (auto & rule : rules) {
+        Bindings bindings;
+        auto     end = it;
+        bool     ok  = true;
+        for (auto & pattern : rule.pattern) {
+          if (end == instrs.end() or not match(pattern, *end, bindings)) {
+            ok = false;
+            break;
+          }
+          ++end;
+        }
+        if (ok and not rule.readOnce.empty()) {
+          const std::string & t = bindings[rule.readOnce];
+          ok = InstructionInfo::isTemp(t) and reads[t] == 1;
+        }
+        if (not ok) continue;
+
+        for (auto r = it; r != end; ++r)
+          for (auto & name : InstructionInfo::getUses(*r)) --reads[name];
+        it = instrs.erase(it, end);
+        for (auto & words : rule.replacement) {
+          instruction instr = instantiate(words, bindings);
+          for (auto & name : InstructionInfo::getUses(instr)) ++reads[name];
+          instrs.insert(it, instr);
+        }
+        ++applied[rule.name];
+        rewritten = true;
+        break;
+      }
+      if (rewritten) {
+        // the replacement may start a new match with the instruction
+        // before it
+        if (it != instrs.begin()) --it;
+        if (it != instrs.begin()) --it;
+        changed = anyChange = true;
+      }
+      else ++it;
+    }
+  }
+
+  for (auto & entry : applied)
+    Stats.addCounter(subr.name, "peephole." + entry.first, entry.second);
+  return anyChange;
+}
+
+bool PeepholeOptimizer::match(const std::vector<std::string> & pattern, const instruction & instr,
+                              Bindings & bindings) {
+  const std::string * args[] = {&instr.oper, &instr.arg1, &instr.arg2, &instr.arg3};
+  for (int i = 0; i < 4; ++i) {
+    const std::string & arg = *args[i];
+    if (i >= int(pattern.size())) {
+      if (not arg.empty()) return false;
+      continue;
+    }
+    const std::string & word = pattern[i];
+    if (word[0] != '$') {
+      if (word != arg) return false;
+      continue;
+    }
+    auto it = bindings.find(word);
+    if (it != bindings.end()) {
+      if (it->second != arg) return false;
+      continue;
+    }
+    // different variables, different args
+    for (auto & bound : bindings)
+      if (bound.second == arg) return false;
+    bindings[word] = arg;
+  }
+  return true;
+}
+
+instruction PeepholeOptimizer::instantiate(const std::vector<std::string> & words,
+                                           const Bindings & bindings) {
+  std::string args[4];
+  for (int i = 0; i < int(words.size()); ++i)
+    args[i] = (words[i][0] == '$') ? bindings.at(words[i]) : words[i];
+  return instruction(args[0], args[1], args[2], args[3]);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class PeepholeOptimizer: rewrites short sequences of consecutive
+// instructions with a table of rules. A rule is a pattern, written as
+// t-code with $variables ("LOAD $t 1", "MUL $t $x $t"), and the
+// instructions replacing it ("LOAD $t $x"). A variable matches any
+// arg, the same one everywhere in the pattern (and different
+// variables match different args); the rest must be equal. The window
+// slides over the instructions of a subroutine until no rule applies.
+// Each rule has its counter in the CodeStats ("peephole.<rule>"), to
+// see which ones pay off.
+
+class PeepholeOptimizer {
+
+public:
+
+  // Constructor
+  PeepholeOptimizer(CodeStats & Stats);
+
+  // Runs the pass on subr. Returns true if the code changed
+  bool run(subroutine & subr);
+
+private:
+
+  struct Rule {
+    std::string                           name;
+    std::vector<std::vector<std::string>> pattern;       // oper arg1 arg2 arg3
+    std::vector<std::vector<std::string>> replacement;
+    std::string                           readOnce;      // a temporal the pattern
+                                                          // reads, not read elsewhere
+  };
+
+  // Attributes
+  CodeStats       & Stats;
+  std::vector<Rule> rules;
+
+  typedef std::map<std::string, std::string> Bindings;
+
+  // Adds a rule of the table, splitting the words of its instructions
+  void addRule(const std::string & name, const std::vector<std::string> & pattern,
+               const std::vector<std::string> & replacement, const std::string & readOnce = "");
+
+  // Binds the variables of pattern to match instr
+  static bool match(const std::vector<std::string> & pattern, const instruction & instr,
+                    Bindings & bindings);
+
+  // The instruction of the replacement, with the args bound
+  static instruction instantiate(const std::vector<std::string> & words,
+                                 const Bindings & bindings);
+
+};  // class PeepholeOptimizer
@@ -0,0 +1,127 @@
+#include "RedundantLoadElimination.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ControlFlowGraph.h"
+#include "InstructionInfo.h"
+#include "SSAForm.h"
+
+#include <vector>
+
+// using namespace std;
+
+
+// Constructor
+RedundantLoadElimination::RedundantLoadElimination(CodeStats & Stats) :
+  Stats{Stats} {
+}
+
+int RedundantLoadElimination::run(const subroutine & subr, ControlFlowGraph & cfg, SSAForm & ssa) {
+  params.clear();
+  escaped.clear();
+  unstable.clear();
+  defOf.clear();
+  for (auto & param : subr.params)
+    params.insert(param.name);
+  for (auto & block : cfg.blocks)
+    for (auto & instr : block.instructions) {
+      std::string def = InstructionInfo::getDef(instr);
+      if (not def.empty()) {
+        if (ssa.isPinned(def)) unstable.insert(def);
+        else                   defOf.insert({def, instr});
+      }
+      if (instr.oper == "ALOAD" and not params.count(instr.arg2)) escaped.insert(instr.arg2);
+    }
+
+  // An element known in memory, with the name holding its value
+  struct Known {
+    Element     element;
+    std::string value;
+    bool        stored;    // by a XLOAD, not read by a LOADX
+  };
+
+  int redundant = 0, forwarded = 0;
+  for (auto & block : cfg.blocks) {
+    std::vector<Known> known;
+    for (auto & instr : block.instructions) {
+      if (instr.oper == "CALL") {
+        // the callee may write the parameters and the arrays passed
+        for (auto it = known.begin(); it != known.end(); ) {
+          const Region & r = it->element.region;
+          if (r.kind != Region::LOCAL or escaped.count(r.name)) it = known.erase(it);
+          else ++it;
+        }
+        continue;
+      }
+      if (instr.oper != "LOADX" and instr.oper != "XLOAD") continue;
+
+      bool        isLoad = instr.oper == "LOADX";
+      std::string base   = isLoad ? instr.arg2 : instr.arg1;
+      std::string offset = isLoad ? instr.arg3 : instr.arg2;
+      std::string value  = isLoad ? instr.arg1 : instr.arg3;
+      Element     e{regionOf(base), offset};
+      bool        stable = not unstable.count(offset) and not unstable.count(value);
+
+      if (isLoad) {
+        auto k = known.begin();
+        while (k != known.end() and not sameElement(k->element, e)) ++k;
+        if (k != known.end()) {
+          instr = instruction::LOAD(value, k->value);
+          ++(k->stored ? forwarded : redundant);
+        }
+        else if (stable)
+          known.push_back({e, value, false});
+      }
+      else {
+        for (auto it = known.begin(); it != known.end(); ) {
+          if (mayAlias(it->element, e)) it = known.erase(it);
+          else ++it;
+        }
+        if (stable) known.push_back({e, value, true});
+      }
+    }
+  }
+
+  Stats.addCounter(subr.name, "loads.redundant", redundant);
+  Stats.addCounter(subr.name, "loads.forwarded", forwarded);
+  return redundant + forwarded;
+}
+
+RedundantLoadElimination::Region RedundantLoadElimination::regionOf(const std::string & base) const {
+  // through the copies of the address, to the array or the parameter
+  std::string name = base;
+  while (InstructionInfo::isTemp(name)) {
+    auto it = defOf.find(name);
+    if (it == defOf.end()) break;
+    const instruction & def = it->second;
+    if ((def.oper != "LOAD" and def.oper != "ALOAD") or not InstructionInfo::isName(def.arg2))
+      break;
+    name = def.arg2;
+  }
+  if (InstructionInfo::isTemp(name) or unstable.count(name))
+    return Region{Region::UNKNOWN, ""};
+  if (params.count(name))
+    return Region{Region::PARAM, name};
+  return Region{Region::LOCAL, name};
+}
+
+bool RedundantLoadElimination::mayAlias(const Element & a, const Element & b) const {
+  const Region & ra = a.region, & rb = b.region;
+  bool sameArray = ra.kind == Region::UNKNOWN or rb.kind == Region::UNKNOWN or
+                   (ra.kind == rb.kind and (ra.name == rb.name or ra.kind == Region::PARAM));
+  if (not sameArray) return false;
+  // in the same array, different literal offsets are different elements
+  auto literal = [&](const std::string & offset) -> std::string {
+    if (not InstructionInfo::isName(offset)) return offset;
+    auto it = defOf.find(offset);
+    if (it == defOf.end() or it->second.oper != "ILOAD") return "";
+    return it->second.arg2;
+  };
+  std::string la = literal(a.offset), lb = literal(b.offset);
+  return la.empty() or lb.empty() or la == lb;
+}
+
+bool RedundantLoadElimination::sameElement(const Element & a, const Element & b) const {
+  return a.region.kind != Region::UNKNOWN and a.region.kind == b.region.kind and
+         a.region.name == b.region.name and a.offset == b.offset;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ControlFlowGraph.h"
+#include "SSAForm.h"
+
+#include <map>
+#include <set>
+#include <string>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class RedundantLoadElimination: within each basic block of the SSA
+// form of a subroutine, a LOADX of an element that was just read
+// (LOADX) or written (XLOAD) becomes a copy of the value read or
+// written. The memory model says which stores and calls may change
+// the element in between:
+//   - a local array is its own storage; a store into another array
+//     does not change it, and a call only can if its address was
+//     passed to some call (ALOAD)
+//   - the arrays passed by reference (parameters) may be the same
+//     one, but never a local array of this subroutine
+//   - an array base that can not be traced back is any of them
+// Two accesses to the same array are the same element if their
+// offsets are the same name; two accesses that may be to the same
+// array are to different elements if their offsets are different
+// literals.
+
+class RedundantLoadElimination {
+
+public:
+
+  // Constructor
+  RedundantLoadElimination(CodeStats & Stats);
+
+  // Runs the pass on the blocks of cfg (the code of subr), in the SSA
+  // form ssa. Returns the loads replaced by copies
+  int run(const subroutine & subr, ControlFlowGraph & cfg, SSAForm & ssa);
+
+private:
+
+  // Attributes
+  CodeStats & Stats;
+
+  // The array an access goes to
+  struct Region {
+    enum Kind { LOCAL, PARAM, UNKNOWN } kind;
+    std::string name;    // the local array or the parameter
+  };
+
+  // An element of an array: its region and its offset
+  struct Element {
+    Region      region;
+    std::string offset;
+  };
+
+  // The region of the base address of an access
+  Region regionOf(const std::string & base) const;
+
+  // False if a store to 'b' can not change 'a'
+  bool mayAlias(const Element & a, const Element & b) const;
+
+  // True if the access to 'a' is always the same element as 'b'
+  bool sameElement(const Element & a, const Element & b) const;
+
+  // What the subroutine is made of
+  std::set<std::string>              params;
+  std::set<std::string>              escaped;    // local arrays passed by address
+  std::set<std::string>              unstable;   // not SSA: pinned names written
+  std::map<std::string, instruction> defOf;      // the write of each SSA name
+
+};  // class RedundantLoadElimination
@@ -0,0 +1,376 @@
+#include "SSAForm.h"
+
+#include "../common/code.h"
+#include "ControlFlowGraph.h"
+#include "InstructionInfo.h"
+#include "Liveness.h"
+
+#include <algorithm>
+#include <cstdlib>    // atoi
+#include <functional>
+#include <utility>
+
+// using namespace std;
+
+
+// Constructor
+SSAForm::SSAForm(subroutine & subr, ControlFlowGraph & cfg) :
+  subr{subr},
+  cfg{cfg},
+  lastTemp{0},
+  lastLabel{0},
+  addedEntry{false} {
+  pinned.insert("_result");
+  for (auto & param : subr.params)
+    pinned.insert(param.name);
+  for (auto & instr : subr.instructions) {
+    for (std::string * arg : InstructionInfo::getUseArgs(instr))
+      if (InstructionInfo::isAddressArg(instr, arg) and not InstructionInfo::isTemp(*arg))
+        pinned.insert(*arg);
+    for (auto & arg : {instr.arg1, instr.arg2, instr.arg3})
+      if (InstructionInfo::isTemp(arg))
+        lastTemp = std::max(lastTemp, std::atoi(arg.c_str() + 1));
+  }
+}
+
+bool SSAForm::isPinned(const std::string & name) const {
+  return pinned.count(name);
+}
+
+std::string SSAForm::newTemp() {
+  return "%" + std::to_string(++lastTemp);
+}
+
+void SSAForm::construct() {
+  if (cfg.blocks.empty()) return;
+  if (not cfg.blocks[0].preds.empty()) {
+    cfg.blocks.insert(cfg.blocks.begin(), ControlFlowGraph::BasicBlock());
+    cfg.blocks[0].instructions.push_back(instruction::NOOP());
+    cfg.computeEdges();
+    addedEntry = true;
+  }
+  int n = cfg.blocks.size();
+  phis.assign(n, std::vector<Phi>());
+  cfg.computeDominators();
+
+  // dominance frontiers
+  std::vector<std::set<int>> frontier(n);
+  for (int b = 0; b < n; ++b) {
+    if (cfg.idom[b] == -1 or cfg.blocks[b].preds.size() < 2) continue;
+    for (int p : cfg.blocks[b].preds) {
+      for (int runner = p; runner != cfg.idom[b] and cfg.idom[runner] != -1;
+           runner = cfg.idom[runner]) {
+        frontier[runner].insert(b);
+        if (runner == 0) break;
+      }
+    }
+  }
+
+  // blocks writing each name
+  std::map<std::string, std::set<int>> defBlocks;
+  for (int b = 0; b < n; ++b) {
+    if (cfg.idom[b] == -1) continue;
+    for (auto & instr : cfg.blocks[b].instructions) {
+      std::string def = InstructionInfo::getDef(instr);
+      if (not def.empty() and not isPinned(def)) defBlocks[def].insert(b);
+    }
+  }
+
+  // phis at the iterated dominance frontier, where the name is live
+  Liveness liveness(cfg);
+  for (auto & entry : defBlocks) {
+    const std::string & name = entry.first;
+    std::vector<int>  pending(entry.second.begin(), entry.second.end());
+    std::vector<bool> hasPhi(n, false), queued(n, false);
+    for (int b : pending) queued[b] = true;
+    while (not pending.empty()) {
+      int b = pending.back();
+      pending.pop_back();
+      for (int f : frontier[b]) {
+        if (hasPhi[f] or not liveness.liveIn[f].count(name)) continue;
+        hasPhi[f] = true;
+        phis[f].push_back(Phi{name, name, std::vector<std::string>(cfg.blocks[f].preds.size(), name)});
+        if (not queued[f]) {
+          queued[f] = true;
+          pending.push_back(f);
+        }
+      }
+    }
+  }
+
+  // renaming, down the dominator tree
+  std::vector<std::vector<int>> children(n);
+  for (int b = 1; b < n; ++b)
+    if (cfg.idom[b] != -1) children[cfg.idom[b]].push_back(b);
+  std::map<std::string, std::vector<std::string>> current;
+  rename(0, children, current);
+}
+
+void SSAForm::rename(int b, const std::vector<std::vector<int>> & children,
+                     std::map<std::string, std::vector<std::string>> & current) {
+  std::vector<std::string> written;   // to pop them on the way back
+  auto define = [&](std::string & name) {
+    std::string version = newTemp();
+    originalName[version] = name;
+    current[name].push_back(version);
+    written.push_back(name);
+    name = version;
+  };
+  auto use = [&](std::string & name) {
+    auto it = current.find(name);
+    if (it != current.end() and not it->second.empty()) name = it->second.back();
+  };
+
+  for (auto & phi : phis[b])
+    define(phi.dst);
+  for (auto & instr : cfg.blocks[b].instructions) {
+    for (std::string * arg : InstructionInfo::getUseArgs(instr))
+      use(*arg);
+    std::string def = InstructionInfo::getDef(instr);
+    if (not def.empty() and not isPinned(def)) define(instr.arg1);
+  }
+  for (int s : cfg.blocks[b].succs) {
+    const std::vector<int> & preds = cfg.blocks[s].preds;
+    int j = std::find(preds.begin(), preds.end(), b) - preds.begin();
+    for (auto & phi : phis[s])
+      use(phi.args[j] = phi.name);
+  }
+
+  for (int c : children[b])
+    rename(c, children, current);
+  for (auto & name : written)
+    current[name].pop_back();
+}
+
+int SSAForm::foldCopies() {
+  // the source of a copy is written once, before the copy and every
+  // use of its result: they can read the source instead
+  std::map<std::string, std::string> source;
+  int folded = 0;
+  for (auto & block : cfg.blocks) {
+    instructionList & instrs = block.instructions;
+    for (auto it = instrs.begin(); it != instrs.end(); ) {
+      if (it->oper == "LOAD" and InstructionInfo::isName(it->arg2) and
+          originalName.count(it->arg1) and not isPinned(it->arg2)) {
+        source[it->arg1] = it->arg2;
+        it = instrs.erase(it);
+        ++folded;
+      }
+      else ++it;
+    }
+  }
+  if (folded == 0) return 0;
+
+  auto rewrite = [&](std::string & name) {
+    while (source.count(name)) name = source[name];
+  };
+  for (auto & block : cfg.blocks)
+    for (auto & instr : block.instructions)
+      for (std::string * arg : InstructionInfo::getUseArgs(instr))
+        rewrite(*arg);
+  for (auto & blockPhis : phis)
+    for (auto & phi : blockPhis)
+      for (auto & arg : phi.args)
+        rewrite(arg);
+  return folded;
+}
+
+int SSAForm::destruct() {
+  int n = cfg.blocks.size();
+  if (n == 0) return 0;
+
+  // Liveness of the SSA names: a phi reads its args at the end of the
+  // predecessors and writes its result at the entry of its block
+  std::vector<Liveness::NameSet> liveIn(n), liveOut(n);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int b = n-1; b >= 0; --b) {
+      Liveness::NameSet live;
+      for (int s : cfg.blocks[b].succs) {
+        live.insert(liveIn[s].begin(), liveIn[s].end());
+        const std::vector<int> & preds = cfg.blocks[s].preds;
+        int j = std::find(preds.begin(), preds.end(), b) - preds.begin();
+        for (auto & phi : phis[s]) live.insert(phi.args[j]);
+      }
+      liveOut[b] = live;
+      const instructionList & instrs = cfg.blocks[b].instructions;
+      for (auto it = instrs.rbegin(); it != instrs.rend(); ++it)
+        Liveness::transfer(*it, live);
+      for (auto & phi : phis[b]) live.erase(phi.dst);
+      if (live != liveIn[b]) {
+        liveIn[b] = live;
+        changed   = true;
+      }
+    }
+  }
+
+  // Interferences between the names of the phis: a value written
+  // while the other is live (but the copies between them)
+  std::set<std::string> phiNames;
+  for (auto & blockPhis : phis)
+    for (auto & phi : blockPhis) {
+      phiNames.insert(phi.dst);
+      phiNames.insert(phi.args.begin(), phi.args.end());
+    }
+  std::set<std::pair<std::string,std::string>> interference;
+  auto interfere = [&](const std::string & a, const Liveness::NameSet & live,
+                       const std::string & except) {
+    if (not phiNames.count(a)) return;
+    for (auto & b : live)
+      if (b != a and b != except and phiNames.count(b)) {
+        interference.insert({a, b});
+        interference.insert({b, a});
+      }
+  };
+  for (int b = 0; b < n; ++b) {
+    Liveness::NameSet live = liveOut[b];
+    const instructionList & instrs = cfg.blocks[b].instructions;
+    for (auto it = instrs.rbegin(); it != instrs.rend(); ++it) {
+      std::string def = InstructionInfo::getDef(*it);
+      if (not def.empty())
+        interfere(def, live, it->oper == "LOAD" ? it->arg2 : "");
+      Liveness::transfer(*it, live);
+    }
+    for (auto & phi : phis[b]) live.insert(phi.dst);
+    for (auto & phi : phis[b]) interfere(phi.dst, live, "");
+  }
+
+  // Coalescing of each phi with its args, while the classes do not
+  // interfere
+  std::map<std::string, std::string> parent;
+  std::function<std::string(const std::string &)> find = [&](const std::string & x) {
+    auto it = parent.find(x);
+    if (it == parent.end() or it->second == x) return x;
+    return it->second = find(it->second);
+  };
+  std::map<std::string, std::vector<std::string>> members;
+  for (auto & name : phiNames) members[name] = {name};
+  for (auto & blockPhis : phis) {
+    for (auto & phi : blockPhis) {
+      for (auto & arg : phi.args) {
+        std::string a = find(phi.dst), c = find(arg);
+        if (a == c) continue;
+        bool canMerge = true;
+        for (auto & x : members[a])
+          for (auto & y : members[c])
+            canMerge = canMerge and not interference.count({x, y});
+        if (not canMerge) continue;
+        parent[c] = a;
+        members[a].insert(members[a].end(), members[c].begin(), members[c].end());
+        members.erase(c);
+      }
+    }
+  }
+
+  // the name of a class: the name before SSA if its value at the
+  // entry is in the class, any of its temporals otherwise
+  std::map<std::string, std::string> nameOf;
+  for (auto & entry : members) {
+    std::string className = entry.first;
+    for (auto & x : entry.second)
+      if (not originalName.count(x)) className = x;
+    for (auto & x : entry.second) nameOf[x] = className;
+  }
+  auto rewrite = [&](std::string & name) {
+    auto it = nameOf.find(name);
+    if (it != nameOf.end()) name = it->second;
+  };
+  for (auto & block : cfg.blocks)
+    for (auto & instr : block.instructions)
+      for (std::string * arg : {&instr.arg1, &instr.arg2, &instr.arg3})
+        rewrite(*arg);
+
+  // The copies left, on the edges into the blocks with phis
+  std::vector<std::map<int, std::vector<std::pair<std::string,std::string>>>> edgeCopies(n);
+  for (int s = 0; s < n; ++s) {
+    for (auto & phi : phis[s]) {
+      rewrite(phi.dst);
+      for (int j = 0; j < int(phi.args.size()); ++j) {
+        rewrite(phi.args[j]);
+        if (phi.args[j] != phi.dst)
+          edgeCopies[cfg.blocks[s].preds[j]][s].push_back({phi.dst, phi.args[j]});
+      }
+    }
+  }
+  phis.assign(n, std::vector<Phi>());
+
+  // Into the predecessor if it only goes to the block with the phis,
+  // into a new block on the edge otherwise
+  int inserted = 0;
+  std::vector<ControlFlowGraph::BasicBlock> newBlocks, splitBlocks;
+  for (int b = 0; b < n; ++b) {
+    ControlFlowGraph::BasicBlock & block = cfg.blocks[b];
+    instructionList & instrs = block.instructions;
+    if (not instrs.empty() and instrs.back().oper == "FJUMP" and block.succs.size() == 1)
+      instrs.pop_back();   // jumps where it falls through anyway
+    std::vector<ControlFlowGraph::BasicBlock> fallThrough;
+    for (auto & edge : edgeCopies[b]) {
+      int s = edge.first;
+      instructionList copies = sequentialize(edge.second);
+      inserted += copies.size();
+      if (block.succs.size() == 1) {
+        auto pos = instrs.end();
+        if (not instrs.empty() and InstructionInfo::isJump(instrs.back())) --pos;
+        instrs.insert(pos, copies.begin(), copies.end());
+      }
+      else if (s == block.succs[0]) {
+        // the fall-through edge: a block right after this one
+        fallThrough.push_back(ControlFlowGraph::BasicBlock());
+        fallThrough.back().instructions = copies;
+      }
+      else {
+        // the FJUMP edge: a block at the end, jumping to the target
+        std::string label = "ssa" + std::to_string(++lastLabel);
+        std::string target = InstructionInfo::getLabel(instrs.back());
+        InstructionInfo::setLabel(instrs.back(), label);
+        splitBlocks.push_back(ControlFlowGraph::BasicBlock());
+        instructionList & split = splitBlocks.back().instructions;
+        split.push_back(instruction::LABEL(label));
+        split.insert(split.end(), copies.begin(), copies.end());
+        split.push_back(instruction::UJUMP(target));
+      }
+    }
+    newBlocks.push_back(std::move(block));
+    for (auto & f : fallThrough) newBlocks.push_back(std::move(f));
+  }
+  for (auto & s : splitBlocks) newBlocks.push_back(std::move(s));
+  if (addedEntry) {
+    newBlocks[0].instructions.pop_front();
+    addedEntry = false;
+  }
+  // the blocks left empty (only copies, all folded)
+  newBlocks.erase(std::remove_if(newBlocks.begin(), newBlocks.end(),
+                                 [](const ControlFlowGraph::BasicBlock & block) {
+                                   return block.instructions.empty();
+                                 }),
+                  newBlocks.end());
+  cfg.blocks.swap(newBlocks);
+  cfg.computeEdges();
+  return inserted;
+}
+
+instructionList SSAForm::sequentialize(std::vector<std::pair<std::string,std::string>> copies) {
+  instructionList code;
+  while (not copies.empty()) {
+    // a copy whose destination is not read by the other copies
+    auto ready = copies.end();
+    for (auto it = copies.begin(); it != copies.end() and ready == copies.end(); ++it) {
+      bool read = false;
+      for (auto & other : copies)
+        read = read or (&other != &*it and other.second == it->first);
+      if (not read) ready = it;
+    }
+    if (ready != copies.end()) {
+      code.push_back(instruction::LOAD(ready->first, ready->second));
+      copies.erase(ready);
+      continue;
+    }
+    // a cycle: saves the destination of a copy before writing it
+    std::string saved = newTemp();
+    code.push_back(instruction::LOAD(saved, copies[0].first));
+    for (auto & other : copies)
+      if (other.second == copies[0].first) other.second = saved;
+  }
+  return code;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../common/code.h"
+#include "ControlFlowGraph.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class SSAForm: static single assignment form of the instructions of
+// a subroutine, built over its ControlFlowGraph.
+//   - construct(): every write of a name gets a new temporal, and a
+//     phi is placed at the dominance frontier of the writes of a name
+//     where it is live (pruned SSA). The value of a name at the entry
+//     keeps the name itself
+//   - destruct(): the phis that can share a name with their operands
+//     without their values interfering are coalesced; the rest become
+//     copies at the end of the predecessors (the critical edges are
+//     split with new blocks)
+// There is no phi in t-code, so the phis of each block are kept
+// apart from its instructions. The parameters (_result included) and
+// the arrays live in memory, so they are never renamed. When the code
+// starts with a loop, a NOOP block is put before it while in SSA, so
+// the entry has no predecessors.
+
+class SSAForm {
+
+public:
+
+  // x := phi(args[0], ..., args[n-1]), args[i] coming from the i-th
+  // predecessor of the block
+  struct Phi {
+    std::string              dst;
+    std::string              name;   // the name before SSA
+    std::vector<std::string> args;
+  };
+
+  // Constructor
+  SSAForm(subroutine & subr, ControlFlowGraph & cfg);
+
+  // The phis of each block (while in SSA)
+  std::vector<std::vector<Phi>> phis;
+
+  // Into SSA form
+  void construct();
+
+  // Replaces the names copied with LOAD by their sources, and removes
+  // the copies (while in SSA). Returns the copies removed
+  int foldCopies();
+
+  // Out of SSA form. Returns the copies inserted
+  int destruct();
+
+  // True if name is not renamed (a parameter or an array)
+  bool isPinned(const std::string & name) const;
+
+  // A temporal not used in the subroutine
+  std::string newTemp();
+
+private:
+
+  // Attributes
+  subroutine       & subr;
+  ControlFlowGraph & cfg;
+  std::set<std::string> pinned;
+  int                   lastTemp;    // highest %N in the subroutine
+  int                   lastLabel;   // of the blocks splitting edges
+  bool                  addedEntry;  // a NOOP block before a loop at the entry
+
+  // The names before SSA of the temporals created
+  std::map<std::string, std::string> originalName;
+
+  // Renaming, down the dominator tree from block b
+  void rename(int b, const std::vector<std::vector<int>> & children,
+              std::map<std::string, std::vector<std::string>> & current);
+
+  // The copies (dst, src) done in parallel, as a sequence of LOADs
+  instructionList sequentialize(std::vector<std::pair<std::string,std::string>> copies);
+
+};  // class SSAForm
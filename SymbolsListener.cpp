@@ -6,6 +6,7 @@
 #include "../common/SymTable.h"
 #include "../common/TreeDecoration.h"
 #include "../common/SemErrors.h"
+#include "ModuleInterface.h"
 
 #include <iostream>
 #include <string>
@@ -24,11 +25,13 @@
 SymbolsListener::SymbolsListener(TypesMgr       & Types,
 				 SymTable       & Symbols,
 				 TreeDecoration & Decorations,
-				 SemErrors      & Errors) :
+				 SemErrors      & Errors,
+				 const std::vector<ModuleInterface> & Imports) :
   Types{Types},
   Symbols{Symbols},
   Decorations{Decorations},
-  Errors{Errors} {
+  Errors{Errors},
+  Imports{Imports} {
 }
 
 void SymbolsListener::enterProgram(AslParser::ProgramContext *ctx) {
@@ -37,6 +40,12 @@ void SymbolsListener::enterProgram(AslParser::ProgramContext *ctx) {
   putScopeDecor(ctx, sc);
 }
 void SymbolsListener::exitProgram(AslParser::ProgramContext *ctx) {
+  // Functions of other modules, compiled separately. The ones defined
+  // in this program take precedence over the imported ones
+  for (auto & iface : Imports)
+    for (auto & f : iface.getFunctions())
+      if (not Symbols.findInCurrentScope(f.first))
+        Symbols.addFunction(f.first, f.second);
   // Symbols.print();
   Symbols.popScope();
   DEBUG_EXIT();
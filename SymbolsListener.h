@@ -7,6 +7,9 @@
 #include "../common/SymTable.h"
 #include "../common/TreeDecoration.h"
 #include "../common/SemErrors.h"
+#include "ModuleInterface.h"
+
+#include <vector>
 
 // using namespace std;
 
@@ -15,8 +18,10 @@
 // Class SymbolListener:  derived from AslBaseListener.
 // The tree walker go through the parse tree and call the methods of
 // this listener to register the symbols of the program in the symbol
-// table. If an enter/exit method does not have an associated task,
-// it does not have to be redefined.
+// table. The functions of the imported module interfaces are added to
+// the global scope too, unless the program defines them itself. If an
+// enter/exit method does not have an associated task, it does not have
+// to be redefined.
 
 class SymbolsListener final : public AslBaseListener {
 
@@ -26,7 +31,8 @@ public:
   SymbolsListener(TypesMgr       & Types,
 		  SymTable       & Symbols,
 		  TreeDecoration & TreeNodeProps,
-		  SemErrors      & Errors);
+		  SemErrors      & Errors,
+		  const std::vector<ModuleInterface> & Imports);
 
   void enterProgram(AslParser::ProgramContext *ctx);
   void exitProgram(AslParser::ProgramContext *ctx);
@@ -106,6 +112,7 @@ private:
   SymTable       & Symbols;
   TreeDecoration & Decorations;
   SemErrors      & Errors;
+  const std::vector<ModuleInterface> & Imports;
 
   // Getters for the necessary tree node atributes:
   //   Scope and Type
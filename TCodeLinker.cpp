@@ -0,0 +1,77 @@
+#include "TCodeLinker.h"
+
+#include <fstream>
+#include <set>
+#include <sstream>
+
+// using namespace std;
+
+
+// Constructor
+TCodeLinker::TCodeLinker() {
+}
+
+bool TCodeLinker::addObject(const std::string & fileName) {
+  std::ifstream stream(fileName);
+  if (not stream) return false;
+
+  std::string line;
+  bool inFunction = false;
+  while (std::getline(stream, line)) {
+    std::istringstream words(line);
+    std::string first, second;
+    words >> first >> second;
+
+    if (first == "function") {
+      functions.push_back({second, fileName, {}, {}});
+      inFunction = true;
+    }
+    if (not inFunction) continue;
+
+    functions.back().lines.push_back(line);
+    if (first == "call") functions.back().calls.push_back(second);
+    if (first == "endfunction") inFunction = false;
+  }
+  return true;
+}
+
+bool TCodeLinker::link(std::ostream & os, std::ostream & errs) const {
+  bool ok = true;
+
+  // each function defined only once
+  std::map<std::string, std::string> definedIn;
+  for (auto & f : functions) {
+    if (definedIn.count(f.name)) {
+      errs << "Link error: function '" << f.name << "' defined in " << definedIn[f.name]
+           << " and in " << f.object << std::endl;
+      ok = false;
+    }
+    else definedIn[f.name] = f.object;
+  }
+
+  // every CALL resolved to some object (reported once per function)
+  for (auto & f : functions) {
+    std::set<std::string> reported;
+    for (auto & callee : f.calls) {
+      if (definedIn.count(callee) or reported.count(callee)) continue;
+      errs << "Link error: undefined function '" << callee << "' called from '"
+           << f.name << "' in " << f.object << std::endl;
+      reported.insert(callee);
+      ok = false;
+    }
+  }
+
+  // exactly one main (more than one is already a duplicate definition)
+  if (not definedIn.count("main")) {
+    errs << "Link error: there is no main function in the objects." << std::endl;
+    ok = false;
+  }
+
+  if (not ok) return false;
+
+  for (auto & f : functions) {
+    for (auto & line : f.lines) os << line << std::endl;
+    os << std::endl;
+  }
+  return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class TCodeLinker: links the t-code objects of separately compiled
+// modules (asl -c) into a single program for the VM. Every object is
+// a list of "function <name> ... endfunction" blocks, as printed by
+// code::dump(). The linker checks that each function is defined only
+// once, that every "call <name>" has a definition in some object and
+// that there is exactly one main, the check that TypeCheckListener
+// does with noMainProperlyDeclared() for a single-file program.
+
+class TCodeLinker {
+
+public:
+
+  // Constructor
+  TCodeLinker();
+
+  // Reads the functions of a t-code object. Returns false if the
+  // file can not be opened
+  bool addObject(const std::string & fileName);
+
+  // Checks the objects added so far and prints the linked program to
+  // os. Errors go to errs; returns false if there is any
+  bool link(std::ostream & os, std::ostream & errs) const;
+
+private:
+
+  // A function of an object, kept as the text lines of its dump
+  struct Function {
+    std::string              name;
+    std::string              object;
+    std::vector<std::string> lines;
+    std::vector<std::string> calls;
+  };
+
+  std::vector<Function> functions;
+
+};  // class TCodeLinker
@@ -0,0 +1,119 @@
+#include "TailCallElimination.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "InstructionInfo.h"
+
+#include <algorithm>
+#include <cstdlib>    // atoi
+#include <iterator>
+#include <set>
+#include <vector>
+
+// using namespace std;
+
+
+// Constructor
+TailCallElimination::TailCallElimination(CodeStats & Stats) :
+  Stats{Stats} {
+}
+
+bool TailCallElimination::run(subroutine & subr) {
+  instructionList & instrs = subr.instructions;
+  const std::string entryLabel = "tailcall";
+  int lastTemp = 0;
+  std::map<std::string, instructionList::iterator> labels;
+  for (auto it = instrs.begin(); it != instrs.end(); ++it) {
+    for (auto & arg : {it->arg1, it->arg2, it->arg3})
+      if (InstructionInfo::isTemp(arg))
+        lastTemp = std::max(lastTemp, std::atoi(arg.c_str() + 1));
+    if (InstructionInfo::isLabel(*it)) labels[InstructionInfo::getLabel(*it)] = it;
+  }
+  std::set<std::string> locals;
+  for (auto & var : subr.vars) locals.insert(var.name);
+  bool isFunction = not subr.params.empty() and subr.params.front().name == "_result";
+  std::vector<std::string> params;
+  for (auto & param : subr.params)
+    if (param.name != "_result") params.push_back(param.name);
+  int nArgs = params.size();
+
+  int eliminated = 0;
+  for (auto it = instrs.begin(); it != instrs.end(); ++it) {
+    if (it->oper != "CALL" or it->arg1 != subr.name) continue;
+
+    // the call sequence: the PUSHes of the result slot and of the
+    // arguments before, the POPs after
+    auto first = it, last = std::next(it);
+    bool matches = true;
+    for (int k = 0; k <= nArgs and matches; ++k) {
+      matches = first != instrs.begin() and std::prev(first)->oper == "PUSH";
+      if (matches) --first;
+    }
+    for (int k = 0; k <= nArgs and matches; ++k) {
+      matches = last != instrs.end() and last->oper == "POP";
+      if (matches) ++last;
+    }
+    if (not matches or not first->arg1.empty()) continue;
+
+    // then only the result copied into _result, and RETURN
+    if (isFunction) {
+      const std::string & result = std::prev(last)->arg1;
+      if (result.empty() or last == instrs.end() or last->oper != "LOAD" or
+          last->arg1 != "_result" or last->arg2 != result)
+        continue;
+      ++last;
+    }
+    if (not returnsFrom(last, instrs, labels)) continue;
+
+    // the arguments, not the address of a local array
+    std::vector<std::string> args;
+    for (auto push = std::next(first); push != it; ++push) args.push_back(push->arg1);
+    bool passesLocal = false;
+    for (auto & arg : args) {
+      for (auto def = first; def != instrs.begin() and not passesLocal; ) {
+        --def;
+        if (InstructionInfo::getDef(*def) != arg) continue;
+        passesLocal = def->oper == "ALOAD" and locals.count(def->arg2);
+        break;
+      }
+    }
+    if (passesLocal) continue;
+
+    instructionList code;
+    std::vector<std::string> temps;
+    for (auto & arg : args) {
+      temps.push_back("%" + std::to_string(++lastTemp));
+      code.push_back(instruction::LOAD(temps.back(), arg));
+    }
+    for (int k = 0; k < nArgs; ++k)
+      code.push_back(instruction::LOAD(params[k], temps[k]));
+    code.push_back(instruction::UJUMP(entryLabel));
+
+    it = instrs.erase(first, last);
+    it = instrs.insert(it, code.begin(), code.end());
+    std::advance(it, code.size() - 1);
+    ++eliminated;
+  }
+  if (eliminated > 0) instrs.push_front(instruction::LABEL(entryLabel));
+
+  Stats.addCounter(subr.name, "tailcalls.eliminated", eliminated);
+  return eliminated > 0;
+}
+
+bool TailCallElimination::returnsFrom(instructionList::iterator it, instructionList & instrs,
+                                      const std::map<std::string, instructionList::iterator> & labels) const {
+  // a UJUMP is followed at most once per label (a loop of UJUMPs never returns)
+  std::set<std::string> followed;
+  while (it != instrs.end()) {
+    if (it->oper == "RETURN") return true;
+    if (InstructionInfo::isLabel(*it)) ++it;
+    else if (it->oper == "UJUMP") {
+      std::string label = InstructionInfo::getLabel(*it);
+      auto target = labels.find(label);
+      if (target == labels.end() or not followed.insert(label).second) return false;
+      it = target->second;
+    }
+    else return false;
+  }
+  return false;
+}
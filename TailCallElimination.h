@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+
+#include <map>
+#include <string>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class TailCallElimination: turns the calls of a subroutine to itself
+// that are the last thing it does into a jump to its entry. A call
+// sequence (PUSH of the result slot and of each argument, CALL, a POP
+// per argument and the POP of the result) followed only by the copy
+// of the result into _result (for a function) and a RETURN, maybe
+// through LABELs and UJUMPs, becomes:
+//   - a copy of each argument into a new temporal, and then of each
+//     temporal into its parameter (an argument may read a parameter
+//     assigned before it, as in gcd(b, a % b))
+//   - a UJUMP to a LABEL added at the entry of the subroutine
+// so the recursion runs as a loop, in the same frame. A call passing
+// the address of a local array is left alone: the array of the new
+// activation would be the same one.
+
+class TailCallElimination {
+
+public:
+
+  // Constructor
+  TailCallElimination(CodeStats & Stats);
+
+  // Eliminates the tail calls of subr to itself. Returns true if the
+  // code changed
+  bool run(subroutine & subr);
+
+private:
+
+  // Attributes
+  CodeStats & Stats;
+
+  // True if the code from it on reaches a RETURN without doing
+  // anything else (only LABELs and UJUMPs in between)
+  bool returnsFrom(instructionList::iterator it, instructionList & instrs,
+                   const std::map<std::string, instructionList::iterator> & labels) const;
+
+};  // class TailCallElimination
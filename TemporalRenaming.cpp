@@ -0,0 +1,79 @@
+#include "TemporalRenaming.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ControlFlowGraph.h"
+#include "InstructionInfo.h"
+#include "Liveness.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// using namespace std;
+
+
+// Constructor
+TemporalRenaming::TemporalRenaming(CodeStats & Stats) :
+  Stats{Stats} {
+}
+
+bool TemporalRenaming::run(subroutine & subr) {
+  // temporals in the order they appear
+  std::vector<std::string>             temps;
+  std::map<std::string, std::set<std::string>> interferes;
+  for (auto & instr : subr.instructions)
+    for (auto & arg : {instr.arg1, instr.arg2, instr.arg3})
+      if (InstructionInfo::isTemp(arg) and not interferes.count(arg)) {
+        temps.push_back(arg);
+        interferes[arg];
+      }
+
+  // interferences: the temporal written by an instruction with the
+  // ones live after it (but the source of a copy, that holds the same
+  // value)
+  ControlFlowGraph cfg(subr.instructions);
+  Liveness         liveness(cfg);
+  for (int b = 0; b < int(cfg.blocks.size()); ++b) {
+    Liveness::NameSet live = liveness.liveOut[b];
+    const instructionList & instrs = cfg.blocks[b].instructions;
+    for (auto it = instrs.rbegin(); it != instrs.rend(); ++it) {
+      std::string def = InstructionInfo::getDef(*it);
+      if (InstructionInfo::isTemp(def)) {
+        for (auto & name : live) {
+          if (not InstructionInfo::isTemp(name) or name == def) continue;
+          if (it->oper == "LOAD" and it->arg2 == name) continue;
+          interferes[def].insert(name);
+          interferes[name].insert(def);
+        }
+      }
+      Liveness::transfer(*it, live);
+    }
+  }
+
+  // greedy colouring: the lowest number not taken by a neighbour
+  std::map<std::string, std::string> renamed;
+  std::set<std::string>              used;
+  for (auto & t : temps) {
+    std::set<std::string> taken;
+    for (auto & other : interferes[t])
+      if (renamed.count(other)) taken.insert(renamed[other]);
+    int color = 1;
+    while (taken.count("%" + std::to_string(color))) ++color;
+    renamed[t] = "%" + std::to_string(color);
+    used.insert(renamed[t]);
+  }
+
+  Stats.addCounter(subr.name, "temporals.before", temps.size());
+  Stats.addCounter(subr.name, "temporals.after", used.size());
+
+  bool changed = false;
+  for (auto & instr : subr.instructions)
+    for (std::string * arg : {&instr.arg1, &instr.arg2, &instr.arg3})
+      if (InstructionInfo::isTemp(*arg) and *arg != renamed[*arg]) {
+        *arg    = renamed[*arg];
+        changed = true;
+      }
+  return changed;
+}
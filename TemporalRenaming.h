@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class TemporalRenaming: every newTEMP() of the CodeGenListener is a
+// new %N, never reused in the subroutine. This pass computes where
+// each temporal is live and renames them onto as few temporals as
+// possible: two temporals interfere when one is written while the
+// other is live, and the interference graph is coloured greedily in
+// the order the temporals appear. It runs the last, once the other
+// passes have shortened the live ranges.
+
+class TemporalRenaming {
+
+public:
+
+  // Constructor
+  TemporalRenaming(CodeStats & Stats);
+
+  // Runs the pass on subr. Returns true if the code changed
+  bool run(subroutine & subr);
+
+private:
+
+  // Attributes
+  CodeStats & Stats;
+
+};  // class TemporalRenaming
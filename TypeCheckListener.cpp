@@ -22,11 +22,13 @@
 TypeCheckListener::TypeCheckListener(TypesMgr       & Types,
 				     SymTable       & Symbols,
 				     TreeDecoration & Decorations,
-				     SemErrors      & Errors) :
+				     SemErrors      & Errors,
+				     bool             IsModule) :
   Types{Types},
   Symbols {Symbols},
   Decorations{Decorations},
-  Errors{Errors} {
+  Errors{Errors},
+  IsModule{IsModule} {
 }
 
 void TypeCheckListener::enterProgram(AslParser::ProgramContext *ctx) {
@@ -35,7 +37,9 @@ void TypeCheckListener::enterProgram(AslParser::ProgramContext *ctx) {
   Symbols.pushThisScope(sc);
 }
 void TypeCheckListener::exitProgram(AslParser::ProgramContext *ctx) {
-  if (Symbols.noMainProperlyDeclared())
+  // a module may have no main, but if it has one it must be right
+  if ((not IsModule or Symbols.findInCurrentScope("main")) and
+      Symbols.noMainProperlyDeclared())
     Errors.noMainProperlyDeclared(ctx);
   Symbols.popScope();
   Errors.print();
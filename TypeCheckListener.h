@@ -17,9 +17,10 @@
 // The tree walker go through the parser tree and call the methods of
 // this listener to do the semantic typecheck of the program. This is
 // done once the SymbolsListener has finish and all the symbols of the
-// program has been added to their respective scope. If an enter/exit
-// method does not have an associated task, it does not have to be
-// redefined.
+// program has been added to their respective scope. When checking a
+// module compiled separately (IsModule) main is not required. If an
+// enter/exit method does not have an associated task, it does not
+// have to be redefined.
 
 class TypeCheckListener final : public AslBaseListener {
 
@@ -29,7 +30,8 @@ public:
   TypeCheckListener(TypesMgr       & Types,
 		    SymTable       & Symbols,
 		    TreeDecoration & Decorations,
-		    SemErrors      & Errors);
+		    SemErrors      & Errors,
+		    bool             IsModule);
 
   void enterProgram(AslParser::ProgramContext *ctx);
   void exitProgram(AslParser::ProgramContext *ctx);
@@ -118,6 +120,7 @@ private:
   SymTable       & Symbols;
   TreeDecoration & Decorations;
   SemErrors      & Errors;
+  bool             IsModule;
 
   // Getters for the necessary tree node atributes:
   //   Scope, Type ans IsLValue
@@ -0,0 +1,92 @@
+#include "ValueNumbering.h"
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ControlFlowGraph.h"
+#include "InstructionInfo.h"
+#include "SSAForm.h"
+
+#include <algorithm>  // std::swap
+
+// using namespace std;
+
+
+// Operations whose operands can be swapped
+static const std::set<std::string> commutativeOps = {
+  "ADD", "MUL", "EQ", "FADD", "FMUL", "FEQ", "AND", "OR" };
+
+
+// Constructor
+ValueNumbering::ValueNumbering(CodeStats & Stats) :
+  Stats{Stats} {
+}
+
+int ValueNumbering::run(const std::string & subrName, ControlFlowGraph & cfg, SSAForm & ssa) {
+  int n = cfg.blocks.size();
+  if (n == 0) return 0;
+
+  unstable.clear();
+  for (auto & block : cfg.blocks)
+    for (auto & instr : block.instructions) {
+      std::string def = InstructionInfo::getDef(instr);
+      if (not def.empty() and ssa.isPinned(def)) unstable.insert(def);
+    }
+
+  cfg.computeDominators();
+  std::vector<std::vector<int>> children(n);
+  for (int b = 1; b < n; ++b)
+    if (cfg.idom[b] != -1) children[cfg.idom[b]].push_back(b);
+
+  replacedBy.clear();
+  std::map<Expression, std::string> available;
+  int replaced = visit(0, children, cfg, available);
+  Stats.addCounter(subrName, "gvn.redundant", replaced);
+  return replaced;
+}
+
+int ValueNumbering::visit(int b, const std::vector<std::vector<int>> & children,
+                          ControlFlowGraph & cfg, std::map<Expression, std::string> & available) {
+  int replaced = 0;
+  std::vector<Expression> added;   // to forget them on the way back
+
+  for (auto & instr : cfg.blocks[b].instructions) {
+    // the operands replaced before are read from the names kept
+    for (std::string * arg : InstructionInfo::getUseArgs(instr)) {
+      auto it = replacedBy.find(*arg);
+      if (it != replacedBy.end() and
+          not (InstructionInfo::isAddressArg(instr, arg) and not InstructionInfo::isTemp(it->second)))
+        *arg = it->second;
+    }
+    Expression e = expressionOf(instr);
+    if (e.empty()) continue;
+    auto it = available.find(e);
+    if (it != available.end()) {
+      replacedBy[instr.arg1] = it->second;
+      instr = instruction::LOAD(instr.arg1, it->second);
+      ++replaced;
+    }
+    else {
+      available[e] = instr.arg1;
+      added.push_back(e);
+    }
+  }
+
+  for (int c : children[b])
+    replaced += visit(c, children, cfg, available);
+  for (auto & e : added)
+    available.erase(e);
+  return replaced;
+}
+
+ValueNumbering::Expression ValueNumbering::expressionOf(const instruction & instr) const {
+  std::string def = InstructionInfo::getDef(instr);
+  if (def.empty() or unstable.count(def) or not InstructionInfo::isPure(instr) or
+      (instr.oper == "LOAD" and InstructionInfo::isName(instr.arg2)))   // copies
+    return Expression();
+  for (auto & name : InstructionInfo::getUses(instr))
+    if (unstable.count(name)) return Expression();
+
+  Expression e = {instr.oper, instr.arg2, instr.arg3};
+  if (commutativeOps.count(instr.oper) and e[2] < e[1]) std::swap(e[1], e[2]);
+  return e;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../common/code.h"
+#include "CodeStats.h"
+#include "ControlFlowGraph.h"
+#include "SSAForm.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// using namespace std;
+
+
+//////////////////////////////////////////////////////////////////////
+// Class ValueNumbering: common subexpression elimination over the SSA
+// form of a subroutine. Walking down the dominator tree, each pure
+// operation (oper and operands, the operands of ADD, MUL, EQ, AND...
+// in a canonical order) is remembered with the name holding its
+// result; an identical operation in a dominated block becomes a copy
+// of that name (folded later by SSAForm::foldCopies, but the
+// operations after it already read the name kept). In SSA a name
+// never changes, so the result is still there; an operand that is a
+// parameter written in the subroutine is not SSA, and its operations
+// are not remembered. Array reads (LOADX) depend on the memory: they
+// are left for the RedundantLoadElimination.
+
+class ValueNumbering {
+
+public:
+
+  // Constructor
+  ValueNumbering(CodeStats & Stats);
+
+  // Runs the pass on the blocks of cfg, in the SSA form ssa. Returns
+  // the operations replaced by copies
+  int run(const std::string & subrName, ControlFlowGraph & cfg, SSAForm & ssa);
+
+private:
+
+  // Attributes
+  CodeStats & Stats;
+
+  // An operation: oper and its operands
+  typedef std::vector<std::string> Expression;
+
+  // Visits b and the blocks it dominates, with the expressions
+  // available at its entry
+  int visit(int b, const std::vector<std::vector<int>> & children, ControlFlowGraph & cfg,
+            std::map<Expression, std::string> & available);
+
+  // The expression computed by instr, or an empty one if instr can not
+  // be reused (not pure, or reading a name that is not SSA)
+  Expression expressionOf(const instruction & instr) const;
+
+  // Names that are not renamed by SSA and are written in the code
+  std::set<std::string> unstable;
+
+  // The names written by a replaced operation, and the names holding
+  // their value (their later uses read it from there, so the
+  // operations using them can be found equal too)
+  std::map<std::string, std::string> replacedBy;
+
+};  // class ValueNumbering
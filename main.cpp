@@ -11,33 +11,102 @@
 #include "TypeCheckListener.h"
 #include "../common/code.h"
 #include "CodeGenListener.h"
+#include "CallGraphListener.h"
+#include "CodeStats.h"
+#include "CodeOptimizer.h"
+#include "ModuleInterface.h"
+#include "TCodeLinker.h"
 
 #include <iostream>
 #include <fstream>    // ifstream
+#include <set>
+#include <string>
+#include <vector>
 
 #include <cstdio>     // fopen
-#include <cstdlib>    // EXIT_FAILURE, EXIT_SUCCESS
+#include <climits>    // INT_MAX
+#include <cstdlib>    // EXIT_FAILURE, EXIT_SUCCESS, strtol
 
 // using namespace std;
 // using namespace antlr4;
 
 
+// Reads a count (a non-negative int) from arg into n. Returns false,
+// leaving n as it was, if arg is anything else
+static bool readCount(const char * arg, int & n) {
+  char * end;
+  long   value = std::strtol(arg, &end, 10);
+  if (end == arg or *end != '\0' or value < 0 or value > INT_MAX) return false;
+  n = value;
+  return true;
+}
+
 int main(int argc, const char* argv[]) {
   // check the correct use of the program
-  if (argc > 2) {
-    std::cout << "Usage: ./main [<file>]" << std::endl;
+  bool        printStats    = false;   // --stats: print code statistics to std::cerr
+  bool        optimizeCode  = false;   // -O: run the optimization passes on the code
+  int         inlineLimit   = 20;      // --inline-limit <n>: size of the callees inlined (0: none)
+  int         inlineGrowth  = 200;     // --inline-growth <n>: instructions a caller may grow
+  bool        compileModule = false;   // -c: compile a module, writing its interface
+  bool        linkObjects   = false;   // --link: link t-code objects instead of compiling
+  std::vector<std::string> interfaceFiles;  // -i <file.asli>: imported interfaces
+  std::vector<std::string> objectFiles;
+  const char *fileName      = nullptr;
+  bool        badUsage      = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--stats")
+      printStats = true;
+    else if (arg == "-O")
+      optimizeCode = true;
+    else if (arg == "--inline-limit" and i+1 < argc) {
+      if (not readCount(argv[++i], inlineLimit)) badUsage = true;
+    }
+    else if (arg == "--inline-growth" and i+1 < argc) {
+      if (not readCount(argv[++i], inlineGrowth)) badUsage = true;
+    }
+    else if (arg == "-c")
+      compileModule = true;
+    else if (arg == "-i" and i+1 < argc)
+      interfaceFiles.push_back(argv[++i]);
+    else if (arg == "--link")
+      linkObjects = true;
+    else if (linkObjects and arg[0] != '-')
+      objectFiles.push_back(arg);
+    else if (not fileName and arg[0] != '-')
+      fileName = argv[i];
+    else
+      badUsage = true;
+  }
+  if (badUsage or (compileModule and not fileName) or
+      (linkObjects and (compileModule or objectFiles.empty()))) {
+    std::cout << "Usage: ./main [-O [--inline-limit <n>] [--inline-growth <n>]] [--stats] [-c] [-i <interface>]... [<file>]" << std::endl;
+    std::cout << "       ./main --link <object>..." << std::endl;
     return EXIT_FAILURE;
   }
-  if (argc == 2 and not std::fopen(argv[1], "r")) {
-    std::cout << "No such file: " << argv[1] << std::endl;
+
+  // link the objects of separately compiled modules into a program
+  if (linkObjects) {
+    TCodeLinker linker;
+    for (auto & obj : objectFiles) {
+      if (not linker.addObject(obj)) {
+        std::cout << "No such file: " << obj << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    return linker.link(std::cout, std::cerr) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if (fileName and not std::fopen(fileName, "r")) {
+    std::cout << "No such file: " << fileName << std::endl;
     return EXIT_FAILURE;
   }
 
   // open input file (or std::cin) and create a character stream
   antlr4::ANTLRInputStream input;
-  if (argc == 2) {  // reads from <file>
+  if (fileName) {   // reads from <file>
     std::ifstream stream;
-    stream.open(argv[1]);
+    stream.open(fileName);
     input = antlr4::ANTLRInputStream(stream);
   }
   else {            // reads fron std::cin
@@ -52,7 +121,7 @@ int main(int argc, const char* argv[]) {
   AslParser parser(&tokens);
 
   // call the parser and get the parse tree
-  antlr4::tree::ParseTree *tree = parser.program();
+  AslParser::ProgramContext *tree = parser.program();
 
   // check for lexical or syntactical errors
   if (lexer.getNumberOfSyntaxErrors() > 0 or
@@ -75,15 +144,25 @@ int main(int argc, const char* argv[]) {
   TreeDecoration decorations;
   SemErrors      errors;
 
+  // Signatures of the functions of other modules, compiled separately
+  std::vector<ModuleInterface> imports;
+  for (auto & iface : interfaceFiles) {
+    imports.push_back(ModuleInterface(types));
+    if (not imports.back().read(iface)) {
+      std::cout << "Wrong or missing interface file: " << iface << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   // Create a Listener that looks for variables and function declarations in the tree
   // and stores required information
-  SymbolsListener symboldecl(types, symbols, decorations, errors);
+  SymbolsListener symboldecl(types, symbols, decorations, errors, imports);
   // Traverse the tree using this listener, to collect information about declared identifiers
   walker.walk(&symboldecl, tree);
 
   // Create another Listener that will perform type checkings wherever it is needed
   // (on expressions, assignments, parameter passing, etc)
-  TypeCheckListener typecheck(types, symbols, decorations, errors);
+  TypeCheckListener typecheck(types, symbols, decorations, errors, compileModule);
   // Traverse the tree using this listener, so all types are checked
   walker.walk(&typecheck, tree);
 
@@ -92,15 +171,70 @@ int main(int argc, const char* argv[]) {
     return EXIT_FAILURE;
   }
 
+  // A module exports the signatures of all its functions but main
+  // to <file>.asli, next to the source file
+  if (compileModule) {
+    ModuleInterface exports(types);
+    symbols.pushThisScope(decorations.getScope(tree));
+    for (auto f : tree->function()) {
+      std::string name = f->ID()->getText();
+      if (name != "main") exports.addFunction(name, symbols.getType(name));
+    }
+    symbols.popScope();
+
+    std::string ifaceName = fileName;
+    if (ifaceName.size() > 4 and ifaceName.substr(ifaceName.size()-4) == ".asl")
+      ifaceName.erase(ifaceName.size()-4);
+    if (not exports.write(ifaceName + ".asli")) {
+      std::cout << "Can not write interface file: " << ifaceName << ".asli" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
   // Auxiliary class to store the code we will be creating
   code mycode;
+  // Statistics of the generated code, filled up while generating it
+  CodeStats stats;
+  // Create a listener that builds the call graph of the program
+  CallGraphListener callgraph;
+  // Traverse the tree using this listener, so the calls between functions are known
+  walker.walk(&callgraph, tree);
+  // Only the functions reachable from main get code. A module has
+  // no main and all its functions can be called from other modules
+  std::set<std::string> reachable;
+  for (auto f : tree->function()) {
+    std::string name = f->ID()->getText();
+    if (compileModule) reachable.insert(name);
+    else if (name == "main") reachable = callgraph.getReachable(name);
+  }
+
   // Create a third listener that will generate code for each part of the tree
-  CodeGenListener codegenerator(types, symbols, decorations, mycode);
-  // Traverse the tree using this listener, so code is generated and stored in 'mycode'
-  walker.walk(&codegenerator, tree);
+  CodeGenListener codegenerator(types, symbols, decorations, mycode, stats);
+  // Traverse each reachable function using this listener, so code is
+  // generated and stored in 'mycode'
+  codegenerator.enterProgram(tree);
+  int dropped = 0;
+  for (auto f : tree->function()) {
+    if (reachable.count(f->ID()->getText())) walker.walk(&codegenerator, f);
+    else ++dropped;
+  }
+  codegenerator.exitProgram(tree);
+  stats.addCounter("$program$", "dropped_functions", dropped);
+
+  // Optimize the generated code
+  if (optimizeCode) {
+    CodeOptimizer optimizer(mycode, stats, inlineLimit, inlineGrowth);
+    optimizer.optimize();
+  }
 
   // print generated code as output
   std::cout << mycode.dump() << std::endl;
 
+  // print the statistics apart from the code, so it can still be piped to the VM
+  if (printStats) {
+    stats.collect(mycode);
+    stats.print(std::cerr);
+  }
+
   return EXIT_SUCCESS;
 }
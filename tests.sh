@@ -0,0 +1,51 @@
+#!/bin/bash
+
+# CONSTANTS
+red_color="\033[01;38;5;196m"
+green_color="\033[01;38;5;118m"
+no_color="\033[00m"
+
+failed=0
+
+
+# ControlFlowGraph: round trip of lower(), and the succs, idom and
+# loops of a nested while/if
+check_cfg() {
+
+    g++ -std=c++11 -I. tests/ControlFlowGraphTest.cpp ControlFlowGraph.cpp \
+        InstructionInfo.cpp ../common/code.cpp -o cfgtest.temp &&
+    ./cfgtest.temp > out.temp
+    [[ $? == 0 ]] &&
+        echo -e "${green_color}OK: $(cat out.temp)${no_color}\n" ||
+        { echo -e "${red_color}$(cat out.temp)${no_color}\n"; failed=1; }
+}
+
+# Optimizations: each tests/<name>.asl, compiled with and without -O,
+# prints <name>.out when run with <name>.in
+check_opt() {
+
+    for fitxer in tests/*.asl
+    do
+        nom_fitxer=${fitxer%.asl}
+        for opt in "" "-O"
+        do
+            ./asl $opt $fitxer > tcode.temp
+            diff $nom_fitxer.out <(../tvm/tvm tcode.temp < $nom_fitxer.in) > out_diff.temp
+            [[ $? == 0 ]] &&
+                echo -e "${green_color}OK: $fitxer $opt${no_color}\n" ||
+                { echo -e "${red_color}$fitxer $opt\n$(cat out_diff.temp)${no_color}\n"; failed=1; }
+        done
+    done
+}
+
+clean() {
+
+    rm -f *.temp
+}
+
+echo "It is assumed you are running the script inside asl folder, paths are relative"
+[[ -e asl ]] || { echo "asl executable doesn't exist, please make it" && exit 1; }
+check_cfg
+check_opt
+clean
+exit $failed
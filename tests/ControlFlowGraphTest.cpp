@@ -0,0 +1,109 @@
+#include "../ControlFlowGraph.h"
+#include "../../common/code.h"
+
+#include <cstdlib>    // EXIT_FAILURE, EXIT_SUCCESS
+#include <iostream>
+#include <string>
+#include <vector>
+
+// using namespace std;
+
+
+// Checks of the ControlFlowGraph of the t-code of a subroutine with a
+// nested while and if:
+//
+//   func f(n : int)
+//     var i, s : int
+//     i = 0; s = 0;
+//     while i < n do
+//       while s < i do
+//         if s == i then write s; endif
+//         s = s + 1;
+//       endwhile
+//       i = i + 1;
+//     endwhile
+//   endfunc
+//
+// and of a few instruction lists without any meaning, with the corner
+// cases of the splitting into blocks. Prints each failed check, and
+// exits with EXIT_FAILURE if there is any.
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what) {
+  if (ok) return;
+  std::cout << "FAILED: " << what << std::endl;
+  ++failures;
+}
+
+// lower() of the blocks of code, with nothing changed, is code again
+static void checkRoundTrip(const instructionList & code, const std::string & name) {
+  check(ControlFlowGraph(code).lower().dump() == code.dump(), name + ": round trip");
+}
+
+static instructionList nestedLoops() {
+  return instruction::ILOAD("i", "0") ||             // block 0
+         instruction::ILOAD("s", "0") ||
+         instruction::LABEL("while1") ||             // block 1: outer header
+         instruction::LT("%1", "i", "n") ||
+         instruction::FJUMP("%1", "endwhile1") ||
+         instruction::LABEL("while2") ||             // block 2: inner header
+         instruction::LT("%2", "s", "i") ||
+         instruction::FJUMP("%2", "endwhile2") ||
+         instruction::EQ("%3", "s", "i") ||          // block 3: if
+         instruction::FJUMP("%3", "endif1") ||
+         instruction::WRITEI("s") ||                 // block 4: then
+         instruction::WRITELN() ||
+         instruction::LABEL("endif1") ||             // block 5
+         instruction::ILOAD("%4", "1") ||
+         instruction::ADD("s", "s", "%4") ||
+         instruction::UJUMP("while2") ||
+         instruction::LABEL("endwhile2") ||          // block 6
+         instruction::ILOAD("%5", "1") ||
+         instruction::ADD("i", "i", "%5") ||
+         instruction::UJUMP("while1") ||
+         instruction::LABEL("endwhile1") ||          // block 7
+         instruction::RETURN();
+}
+
+int main() {
+  instructionList code = nestedLoops();
+  checkRoundTrip(code, "nested loops");
+
+  ControlFlowGraph cfg(code);
+  check(cfg.blocks.size() == 8, "nested loops: 8 blocks");
+  if (cfg.blocks.size() == 8) {
+    std::vector<std::vector<int>> succs = {{1}, {2, 7}, {3, 6}, {4, 5}, {5}, {2}, {1}, {}};
+    for (int b = 0; b < 8; ++b)
+      check(cfg.blocks[b].succs == succs[b], "nested loops: succs of block " + std::to_string(b));
+
+    cfg.computeLoops();
+    check(cfg.idom == std::vector<int>({0, 0, 1, 2, 3, 3, 2, 1}), "nested loops: idom");
+    check(cfg.loops.size() == 2, "nested loops: 2 loops");
+    if (cfg.loops.size() == 2) {
+      const ControlFlowGraph::Loop & outer = cfg.loops[0], & inner = cfg.loops[1];
+      check(outer.header == 1 and outer.blocks == std::vector<int>({1, 2, 3, 4, 5, 6}) and
+            outer.parent == -1 and outer.depth == 1, "nested loops: outer loop");
+      check(inner.header == 2 and inner.blocks == std::vector<int>({2, 3, 4, 5}) and
+            inner.parent == 0 and inner.depth == 2, "nested loops: inner loop");
+    }
+    check(cfg.loopOf == std::vector<int>({-1, 0, 1, 1, 1, 1, 0, -1}), "nested loops: loopOf");
+    check(cfg.loopDepth(0) == 0 and cfg.loopDepth(6) == 1 and cfg.loopDepth(4) == 2,
+          "nested loops: loopDepth");
+    check(cfg.canInsertPreheader(0) and cfg.canInsertPreheader(1),
+          "nested loops: preheaders");
+  }
+
+  // consecutive LABELs, a FJUMP alone in its block (as in a and b),
+  // code no label reaches and a subroutine that starts with a loop
+  checkRoundTrip(instruction::LABEL("a") || instruction::LABEL("b") ||
+                 instruction::FJUMP("x", "c") || instruction::FJUMP("y", "c") ||
+                 instruction::UJUMP("a") || instruction::WRITEI("x") ||
+                 instruction::LABEL("c") || instruction::RETURN() || instruction::RETURN(),
+                 "corner cases");
+  checkRoundTrip(instructionList(), "empty subroutine");
+
+  if (failures > 0) return EXIT_FAILURE;
+  std::cout << "ControlFlowGraph: all checks passed" << std::endl;
+  return EXIT_SUCCESS;
+}